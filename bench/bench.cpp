@@ -0,0 +1,146 @@
+// bench - host benchmarks of the interpreter, from the top of the tree:
+//
+//   g++ -O2 -o cortex-bench bench/bench.cpp src/cortex.cpp
+//   ./cortex-bench > before.tsv
+//   ./cortex-bench before.tsv
+//
+// each benchmark evaluates its setup once, then reads, evaluates and prints its expression
+// a fixed number of times; the report is tab-separated with a line per benchmark, and given
+// an earlier report it adds the change in time per eval
+
+#include "../src/cortex.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct Bench {
+    const char *name;
+    const char *setup;
+    const char *expr;
+    int runs;
+};
+
+Bench benches[] = {
+    { "fib",
+      "(defun fib (n) (cond ((lessp n 2) n) (t (+ (fib (- n 1)) (fib (- n 2))))))",
+      "(fib 20)", 20 },
+
+    { "tak",
+      "(defun tak (x y z) (cond ((not (lessp y x)) z)"
+      " (t (tak (tak (sub1 x) y z) (tak (sub1 y) z x) (tak (sub1 z) x y)))))",
+      "(tak 18 12 6)", 10 },
+
+    { "list",
+      "(defun mk (n) (prog (l) loop (cond ((zerop n) (return l)))"
+      " (setq l (cons n l)) (setq n (sub1 n)) (go loop)))\n"
+      "(defun rev (l a) (cond ((null l) a) (t (rev (cdr l) (cons (car l) a)))))\n"
+      "(defun len (l k) (cond ((null l) k) (t (len (cdr l) (add1 k)))))",
+      "(len (rev (mk 1000) nil) 0)", 200 },
+
+    { "prog",
+      "(defun sum (n) (prog (i s) (setq i 0) (setq s 0)"
+      " loop (cond ((lessp n i) (return s))) (setq s (+ s i)) (setq i (add1 i)) (go loop)))",
+      "(sum 10000)", 100 },
+
+    { "cond",
+      "(defun cls (n) (cond ((zerop n) 'a) ((zerop (- n 1)) 'b) ((zerop (- n 2)) 'c)"
+      " ((zerop (- n 3)) 'd) ((zerop (- n 4)) 'e) ((zerop (- n 5)) 'f) ((zerop (- n 6)) 'g)"
+      " ((zerop (- n 7)) 'h) ((zerop (- n 8)) 'i) ((zerop (- n 9)) 'j) ((zerop (- n 10)) 'k)"
+      " ((zerop (- n 11)) 'l) ((zerop (- n 12)) 'm) ((zerop (- n 13)) 'n) ((zerop (- n 14)) 'o)"
+      " (t 'p)))\n"
+      "(defun walk (n k) (prog () loop (cond ((zerop n) (return k)))"
+      " (setq k (cls (- n (* 16 (/ n 16))))) (setq n (sub1 n)) (go loop)))",
+      "(walk 2000 nil)", 50 },
+
+    { "read",
+      "",
+      "(quote (define (walk tree) (cond ((null tree) 0) ((atom tree) 1)"
+      " (t (plus (walk (car tree)) (walk (cdr tree)))))) (alpha beta gamma delta epsilon)"
+      " (1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16) ((a b) (c d) (e f) (g h) (i j) (k l))"
+      " 'quoted '(nested (deeper (deepest x))) [square brackets] 12345 678 9))",
+      2000 },
+};
+
+int null_getc(void *) { return EOF; }
+void null_putc(int c, void *) { }
+
+uint64_t nanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// baseline - time per eval of name in an earlier report, or 0
+double baseline(FILE *f, const char *name) {
+    char line[256];
+
+    if (f == nil) {
+        return 0;
+    }
+
+    rewind(f);
+    while (fgets(line, sizeof(line), f) != nil) {
+        char *tab = strchr(line, '\t');
+        if (tab != nil && tab - line == (int)strlen(name) && strncmp(line, name, tab - line) == 0) {
+            strtol(tab + 1, &tab, 10); // runs
+            return strtod(tab + 1, nil);
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    CortexIo null = { null_getc, null_putc, nil, nil, nil };
+    Cortex cortex(null);
+
+    FILE *before = (argc > 1) ? fopen(argv[1], "r") : nil;
+    FILE *report = stdout;
+
+    fprintf(report, "bench\truns\tns_per_eval\tcells_per_eval\tgcs\tpeak_live\theap_cells%s\n",
+        (before != nil) ? "\tchange" : "");
+
+    for (unsigned i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        Bench *b = &benches[i];
+
+        cortex.eval(b->setup);
+        if (cortex.error() != nil) {
+            fprintf(report, "%s\terror\n", b->name);
+            continue;
+        }
+
+        cortex.eval("(gc)");
+        CortexStats s = cortex.stats();
+        uint64_t t = nanos();
+
+        bool ok = true;
+        for (int n = 0; ok && n < b->runs; n++) {
+            cortex.print(cortex.eval(b->expr));
+            ok = (cortex.error() == nil);
+        }
+
+        t = nanos() - t;
+        if (!ok) {
+            fprintf(report, "%s\terror\n", b->name);
+            continue;
+        }
+
+        CortexStats e = cortex.stats();
+        int live = (e.peak < e.cells - e.cellsfree) ? e.cells - e.cellsfree : e.peak;
+        double ns = (double)t / b->runs;
+
+        fprintf(report, "%s\t%d\t%.0f\t%u\t%u\t%d\t%d", b->name, b->runs, ns,
+            (e.allocs - s.allocs) / b->runs, e.gcs - s.gcs, live, e.cells);
+
+        double was = baseline(before, b->name);
+        if (was > 0) {
+            fprintf(report, "\t%+.1f%%", 100 * (ns - was) / was);
+        }
+        fprintf(report, "\n");
+    }
+
+    return 0;
+}
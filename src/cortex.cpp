@@ -0,0 +1,4679 @@
+#if __MBED__
+#include "mbed.h"
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <new>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if !__MBED__
+#include <condition_variable>
+#include <mutex>
+#include <time.h>
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#endif
+
+#include "cortex.h"
+
+#if __MBED__
+unsigned _micros() { return us_ticker_read(); }
+#else
+unsigned _micros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+#endif
+
+// _cycles - fine-grained clock for the profiler, the DWT cycle counter extended past 32 bits
+// on Cortex-M (read often enough not to miss a wrap), nanoseconds on the host
+#if __MBED__ && defined(DWT_CTRL_CYCCNTENA_Msk)
+#define CYCLES "cycles"
+
+void _cycles_init() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint64_t _cycles() {
+    static uint32_t last;
+    static uint64_t high;
+
+    uint32_t now = DWT->CYCCNT;
+    if (now < last) {
+        high += 1ull << 32;
+    }
+    last = now;
+
+    return high | now;
+}
+#elif __MBED__
+#define CYCLES "us"
+
+void _cycles_init() { }
+uint64_t _cycles() { return ticker_read_us(get_us_ticker_data()); }
+#else
+#define CYCLES "ns"
+
+void _cycles_init() { }
+uint64_t _cycles() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
+
+typedef enum { EOT = -1, ERR, QUOTED, LPAREN, RPAREN, ALPHA, DIGIT, EOL, BLANK, STRING } token_t;
+
+// what a symbol does at the head of a form: the special forms are told apart here, functions
+// are FUSER or FNATIVE, the natives themselves are in the natives table
+enum {
+    LIST, NUMBER, SYMBOL, LOCAL, VAR, QUOTE, NIL, T, COND, DEFUN, FSETQ, FUNCALL, PROG, GO, RETRN, FAPPLY, FLIST,
+    FAND, FOR, FEVAL, FPROFILE, FUSER, FNATIVE
+};
+
+int isfunc(int t) { return t == FUSER || t == FNATIVE; }
+
+// a Cons is a bare pair of words, every other value is told apart by the low bits of its word:
+// ...1 fixnum, .000 pair (or nil), .010 symbol, .100 local slot reference, .110 float
+struct alignas(8) Cons {
+    Cons *car;
+    Cons *cdr;
+};
+
+// DEFUN compiles the body of a function to bytecode for a stack machine working on the value
+// stack, consts holds the symbols, quoted data and uncompiled forms the bytecode refers to
+struct Code {
+    uint8_t *ops;
+    Cons **consts;
+    int nconsts;
+    Code *next; // in the list of code released while it ran
+};
+
+struct Builtin;
+struct Memo;
+
+// symbols live in their own heap, type is what the symbol does at the head of a form
+struct alignas(8) Symbol {
+    const char *name;
+    Cons *value;
+    int type;
+    Code *code; // compiled body of a FUSER, or nil
+    const Builtin *native; // function of a FNATIVE
+    Memo *memo;            // cache of a memoized FUSER, or nil
+    bool inlined;          // the body of the FUSER is compiled into other functions
+};
+
+const uintptr_t TAGS = 7;
+const uintptr_t SYMTAG = 2;
+const uintptr_t LOCALTAG = 4;
+const uintptr_t FLOATTAG = 6;
+
+Cons *const FREED = (Cons *)(~TAGS | LOCALTAG); // car of the cells on the free list
+
+bool fixnump(Cons *p) { return ((uintptr_t)p & 1) != 0; }
+bool pairp(Cons *p) { return p != nil && ((uintptr_t)p & TAGS) == 0; }
+bool symbolp(Cons *p) { return ((uintptr_t)p & TAGS) == SYMTAG; }
+bool realp(Cons *p) { return ((uintptr_t)p & TAGS) == FLOATTAG; }
+
+// fixnums hold an int less the tag bit on the device; results out of range become floats
+#if UINTPTR_MAX > 0xffffffff
+const long long FIXMAX = INT_MAX;
+#else
+const long long FIXMAX = INT_MAX >> 1;
+#endif
+const long long FIXMIN = -FIXMAX - 1;
+
+// vectors are packed arrays of int16, int32, float or bytes kept outside the cell arena, strings
+// are vectors of bytes that print as text; a vector is a cell whose car is the symbol #vector,
+// which no name reaches, and whose cdr is the address of its Vector tagged as a float, so that
+// the collector does not follow it; sweep deletes the Vector of a cell it frees, and car, cdr
+// and rplaca see a vector as an atom
+enum { I16, I32, F32, U8, STR, VECTYPES_ };
+
+const char *const VECTYPES[] = { "i16", "i32", "f32", "u8", "string" };
+const int VECSIZES[] = { sizeof(int16_t), sizeof(int32_t), sizeof(float), 1, 1 };
+
+// a slice is a Vector over the elements of another, whose cell it keeps alive through owner
+struct alignas(8) Vector {
+    int type;
+    int n;
+    uint8_t *data;
+    Cons *owner; // nil when the elements follow the Vector
+};
+
+extern Vector novector; // of a vector cell whose elements are being allocated
+
+const Symbol vecsym = { "#vector", nil, VAR, nil, nil, nil, false };
+Cons *const VECMARK = (Cons *)((uintptr_t)&vecsym + SYMTAG);
+
+bool vectorp(Cons *p) { return pairp(p) && p->car == VECMARK; }
+Vector *_vec(Cons *p) { return (Vector *)((uintptr_t)p->cdr & ~TAGS); }
+
+int16_t *i16(Vector *v) { return (int16_t *)v->data; }
+int32_t *i32(Vector *v) { return (int32_t *)v->data; }
+float *f32(Vector *v) { return (float *)v->data; }
+
+void unvector(Cons *p) {
+    if (_vec(p) != &novector) {
+        delete[] (char *)_vec(p);
+    }
+}
+
+// cells come from an arena of fixed-size pages, free cells are chained through cdr;
+// pages are added when a collection leaves less than a quarter of the cells free,
+// each page has a mark bit and a frozen bit per cell and the page table is kept sorted by address
+#ifndef MBED_CONF_APP_HEAP_PAGES
+#define MBED_CONF_APP_HEAP_PAGES 128
+#endif
+#ifndef MBED_CONF_APP_PAGE_CELLS
+#define MBED_CONF_APP_PAGE_CELLS 1024
+#endif
+
+const int PAGES = MBED_CONF_APP_HEAP_PAGES;
+const int PAGE = MBED_CONF_APP_PAGE_CELLS;
+
+struct Page {
+    Cons cells[PAGE];
+    uint32_t marks[(PAGE + 31) / 32];
+    uint32_t frozen[(PAGE + 31) / 32]; // shared cells of quoted data, see share
+};
+
+// frames hold the arguments of active FUSER calls and the locals of PROGs,
+// their slots live on the value stack and are named by the parameter list
+struct Frame {
+    Frame *up;
+    Cons *pars;
+    Cons **slots;
+};
+
+// compiled functions and the PROGs inside them keep their frames in call records,
+// ret is where the caller resumes
+struct Call {
+    Code *code;
+    const uint8_t *ret;
+    Frame frame;
+    bool profiled; // the call was entered in the profile
+};
+
+const int STACK = 1024;
+const int CALLS = 256;
+const int MARKS = 256;
+const int TOKEN = 64;
+const int OPS = 1024;
+const int CONSTS = 256;
+
+// symbols and their names are carved from blocks chained to the context that owns them
+struct alignas(8) Block {
+    Block *next;
+};
+
+// the reader pushes back the characters that end a token, last in first out
+const int BACK = 4;
+
+struct Pushback {
+    int n;
+    int c[BACK];
+};
+
+// (load ...) streams a file through the reader a chunk at a time
+const int CHUNK = 64;
+
+struct Source {
+    FILE *file;
+    char chunk[CHUNK];
+    int at, n;
+};
+
+struct Prog;
+struct Profiler;
+
+// Context - everything an interpreter owns; the API points cx at the context it is called on,
+// the syntax table, the builtin names and the dispatch tables are shared
+struct Context {
+    CortexIo io;
+    Pushback back;            // characters pushed back by the reader
+    const char *src, *srcend; // source of Cortex::eval, or nil to read io
+    Source *file;             // file being loaded, read when there is no src
+    const char *error;        // why the last evaluation bailed
+
+    Page *pages[PAGES];
+    int npages;
+    int cells;
+    int cellsfree;
+    unsigned allocs;
+    Cons *freelist;
+
+    Cons *TRUE;
+    Cons *TICK; // the quote the reader wraps around 'x
+
+    Symbol **symtab;
+    unsigned symcap;
+    unsigned symcnt;
+    Symbol *symbols; // block that new symbols are carved from
+    int nsymbols;
+    char *names;
+    int nnames;
+    Block *blocks;
+
+    Cons *stack[STACK];
+    int sp;
+    Call calls[CALLS];
+    int csp;
+    jmp_buf toplevel;
+    void *stackbase;
+    int entered; // API calls in progress, the outermost sets stackbase
+
+    Cons *marks[MARKS];
+    int msp;
+    bool overflow; // marks ran out, rescan the heap for marked cells with unmarked children
+    unsigned gcs, gclast, gcmax, gctotal;
+    int gcpeak; // most cells live after a collection
+
+    bool progon;
+    Cons *label; // a GO is on its way to, for the PROG that has it
+    char token[TOKEN + 1];
+
+    uint8_t ops[OPS];
+    int nops;
+    Cons *consts[CONSTS];
+    int nconsts;
+    bool compiled;
+    Prog *prog; // innermost PROG being compiled
+    Cons *args; // of the call being inlined, the parameters of the callee compile to them
+    bool folding; // bail quietly, a call that does not fold is left to fail when it runs
+
+    bool profiling;
+    Profiler *profiler; // allocated by the first (profile ...)
+
+    FILE *image; // being saved or loaded
+
+    Code *released; // code of redefined functions that was running, see release
+
+    Cons **shared; // hash table of the cells of quoted data
+    unsigned sharecap;
+    unsigned sharecnt;
+};
+
+// cx is the context being run, contexts run on threads of their own: on the host cx is kept
+// per thread, on the device, whose RTOS has no thread-local storage, the contexts take turns
+// under a lock that is let go while a context waits for input or a message
+#if __MBED__
+Context *cx;
+SingletonPtr<PlatformMutex> turn;
+
+Context *idle() {
+    Context *c = cx;
+    turn->unlock();
+    return c;
+}
+
+void resume(Context *c) {
+    turn->lock();
+    cx = c;
+}
+#else
+thread_local Context *cx;
+
+Context *idle() { return cx; }
+void resume(Context *c) { }
+#endif
+
+int _getc() {
+    if (cx->back.n != 0) {
+        return cx->back.c[--cx->back.n];
+    }
+
+    if (cx->src != nil) {
+        return (cx->src < cx->srcend) ? (unsigned char)*cx->src++ : EOF;
+    }
+
+    if (cx->file != nil) {
+        Source *s = cx->file;
+        if (s->at == s->n) {
+            s->n = fread(s->chunk, 1, CHUNK, s->file);
+            s->at = 0;
+        }
+        return (s->at < s->n) ? (unsigned char)s->chunk[s->at++] : EOF;
+    }
+
+    Context *c = idle();
+    int ch = c->io.getc(c->io.user);
+    resume(c);
+
+    return ch;
+}
+
+void _ungetc(int c) {
+    if (c == EOF) { // read again at the end
+        return;
+    }
+    if (cx->back.n == BACK) {
+        bail("pushback");
+    }
+    cx->back.c[cx->back.n++] = c;
+}
+void _putc(int c) { cx->io.putc(c, cx->io.user); }
+
+// _write - n bytes in one call to the console where it takes them in bulk
+void _write(const char *s, size_t n) {
+    if (cx->io.write != nil) {
+        cx->io.write(s, n, cx->io.user);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        _putc(s[i]);
+    }
+}
+
+void _flush() {
+    if (cx->io.flush != nil) {
+        cx->io.flush(cx->io.user);
+    }
+}
+
+void _puts(const char *s);
+
+void _putf(float f) {
+    char buf[24];
+
+    snprintf(buf, sizeof(buf), "%g", f);
+    _puts(buf);
+    if (strpbrk(buf, ".en") == nil) { // reads back as a float, "n" is in inf and nan
+        _puts(".0");
+    }
+}
+
+void _putn(int n) {
+    char buf[sizeof(int) * 3 + 1];
+    int i = sizeof(buf);
+    unsigned u = (n < 0) ? 0u - n : n;
+
+    do {
+        buf[--i] = '0' + u % 10;
+        u /= 10;
+    } while (u != 0);
+    if (n < 0) {
+        buf[--i] = '-';
+    }
+
+    _write(&buf[i], sizeof(buf) - i);
+}
+
+void _puts(const char *s) { _write(s, strlen(s)); }
+
+// _putcol - n right-aligned in a column of width w
+void _putcol(uint64_t n, int w) {
+    char buf[24];
+    int i = sizeof(buf);
+
+    buf[--i] = '\0';
+    do {
+        buf[--i] = '0' + n % 10;
+        n /= 10;
+    } while (n != 0);
+
+    for (int k = sizeof(buf) - 1 - i; k < w; k++) {
+        _putc(' ');
+    }
+    _puts(&buf[i]);
+}
+
+bool grow() {
+    if (cx->npages == PAGES) {
+        return false;
+    }
+
+    Page *page = new (std::nothrow) Page();
+    if (page == nil) {
+        return false;
+    }
+
+    for (int i = PAGE - 1; 0 <= i; i--) {
+        page->cells[i].car = FREED;
+        page->cells[i].cdr = cx->freelist;
+        cx->freelist = &page->cells[i];
+    }
+
+    int j = cx->npages++;
+    for ( ; 0 < j && page < cx->pages[j - 1]; j--) {
+        cx->pages[j] = cx->pages[j - 1];
+    }
+    cx->pages[j] = page;
+
+    cx->cells += PAGE;
+    cx->cellsfree += PAGE;
+
+    return true;
+}
+
+// page - the page holding address a, or nil
+Page *page(uintptr_t a) {
+    int lo = 0;
+    int hi = cx->npages - 1;
+
+    while (lo <= hi) {
+        int m = (lo + hi) / 2;
+        uintptr_t b = (uintptr_t)cx->pages[m]->cells;
+
+        if (a < b) {
+            hi = m - 1;
+        } else if (b + sizeof(cx->pages[m]->cells) <= a) {
+            lo = m + 1;
+        } else {
+            return cx->pages[m];
+        }
+    }
+
+    return nil;
+}
+
+void gc(Cons *car, Cons *cdr);
+void bail(const char *why);
+
+Cons *cons(Cons *car, Cons *cdr) {
+    if (cx->freelist == nil) {
+        gc(car, cdr);
+        if (cx->cellsfree < cx->cells / 4) {
+            grow();
+        }
+        if (cx->freelist == nil) {
+            bail("out of memory");
+        }
+    }
+
+    Cons *p = cx->freelist;
+    cx->freelist = p->cdr;
+    cx->cellsfree--;
+    cx->allocs++;
+
+    p->car = car;
+    p->cdr = cdr;
+
+    return p;
+}
+
+Cons *car(Cons *p) { return (pairp(p) && !vectorp(p)) ? p->car : nil; }
+Cons *cdr(Cons *p) { return (pairp(p) && !vectorp(p)) ? p->cdr : nil; }
+
+int _type(Cons *p) {
+    if (p == nil) {
+        return NIL;
+    }
+
+    switch ((uintptr_t)p & TAGS) {
+        case 0: return LIST;
+        case SYMTAG: return SYMBOL;
+        case LOCALTAG: return LOCAL;
+    }
+
+    return NUMBER;
+}
+
+int _number(Cons *p) { return (int)((intptr_t)p >> 1); }
+int _local(Cons *p) { return (int)((uintptr_t)p >> 3); }
+Symbol *_sym(Cons *p) { return (Symbol *)((uintptr_t)p - SYMTAG); }
+const char *_symbol(Cons *p) { return _sym(p)->name; }
+
+// _op - what x does at the head of a form
+int _op(Cons *x) { return symbolp(x) ? _sym(x)->type : _type(x); }
+
+void rplaca(Cons *p, Cons *q) { p->car = q; }
+void rplacd(Cons *p, Cons *q) { p->cdr = q; }
+
+Cons *number(int n) { return (Cons *)(((uintptr_t)(intptr_t)n << 1) | 1); }
+Cons *local(int n) { return (Cons *)(((uintptr_t)n << 3) | LOCALTAG); }
+
+// a float is kept in its word, so that float results need no cells; above the tag on the host,
+// in place of the three low bits of the mantissa on the device
+Cons *real(float f) {
+    uint32_t b;
+    memcpy(&b, &f, sizeof(b));
+#if UINTPTR_MAX > 0xffffffff
+    return (Cons *)(((uintptr_t)b << 32) | FLOATTAG);
+#else
+    return (Cons *)((b & ~TAGS) | FLOATTAG);
+#endif
+}
+
+float _real(Cons *p) {
+#if UINTPTR_MAX > 0xffffffff
+    uint32_t b = (uint32_t)((uintptr_t)p >> 32);
+#else
+    uint32_t b = (uint32_t)p & ~TAGS;
+#endif
+    float f;
+    memcpy(&f, &b, sizeof(f));
+    return f;
+}
+
+Cons *integer(long long n) { return (FIXMIN <= n && n <= FIXMAX) ? number((int)n) : real((float)n); }
+
+// block - memory that lives as long as the context
+void *block(size_t n) {
+    Block *b = (Block *)new char[sizeof(Block) + n];
+    b->next = cx->blocks;
+    cx->blocks = b;
+    return b + 1;
+}
+
+// symbols are interned in an open-addressing hash table, so that equal names share one symbol
+// and everything past the reader compares symbols by pointer
+const int SYMBOLS = 32;
+
+unsigned hash(const char *s) {
+    unsigned h = 2166136261u; // FNV-1a
+
+    for ( ; *s != '\0'; s++) {
+        h = (h ^ (unsigned char)*s) * 16777619u;
+    }
+
+    return h;
+}
+
+Symbol **probe(Symbol **tab, unsigned cap, const char *name) {
+    unsigned i = hash(name) & (cap - 1);
+
+    while (tab[i] != nil && strcmp(tab[i]->name, name) != 0) {
+        i = (i + 1) & (cap - 1);
+    }
+
+    return &tab[i];
+}
+
+void rehash(unsigned cap) {
+    Symbol **tab = new Symbol *[cap]();
+
+    for (unsigned i = 0; i < cx->symcap; i++) {
+        if (cx->symtab[i] != nil) {
+            *probe(tab, cap, cx->symtab[i]->name) = cx->symtab[i];
+        }
+    }
+
+    delete[] cx->symtab;
+    cx->symtab = tab;
+    cx->symcap = cap;
+}
+
+// enter - put p in the symbol table, in place of a symbol of the same name
+Cons *enter(Symbol *p) {
+    if (cx->symcap < 2 * (cx->symcnt + 1)) {
+        rehash((cx->symcap == 0) ? 128 : 2 * cx->symcap);
+    }
+
+    Symbol **q = probe(cx->symtab, cx->symcap, p->name);
+    cx->symcnt += (*q == nil) ? 1 : 0;
+    *q = p;
+
+    return (Cons *)((uintptr_t)p + SYMTAG);
+}
+
+Cons *declare(const char *name) {
+    if (cx->nsymbols == 0) {
+        cx->symbols = (Symbol *)block(SYMBOLS * sizeof(Symbol));
+        cx->nsymbols = SYMBOLS;
+    }
+
+    Symbol *p = &cx->symbols[--cx->nsymbols];
+    p->name = name;
+    p->value = nil;
+    p->type = VAR;
+    p->code = nil;
+    p->native = nil;
+    p->memo = nil;
+    p->inlined = false;
+
+    return enter(p);
+}
+
+// names of interned symbols are carved from blocks too, the reader keeps them short
+const int NAMES = 256;
+
+Cons *intern(const char *name) {
+    Symbol *p = (cx->symcap == 0) ? nil : *probe(cx->symtab, cx->symcap, name);
+
+    if (p == nil) {
+        int n = strlen(name) + 1;
+        if (cx->nnames < n) {
+            cx->nnames = (n < NAMES) ? NAMES : n;
+            cx->names = (char *)block(cx->nnames);
+        }
+        char *s = cx->names;
+        cx->names += n;
+        cx->nnames -= n;
+        memcpy(s, name, n);
+        return declare(s);
+    }
+
+    return (Cons *)((uintptr_t)p + SYMTAG);
+}
+
+// bail - abandon the evaluation and return to the REPL
+void bail(const char *why) {
+    if (!cx->folding) {
+        _puts("\033[33m");
+        _puts(why);
+        _puts("!" "\033[0m" "\n");
+    }
+    cx->error = why;
+    if (cx->image != nil) {
+        fclose(cx->image);
+        cx->image = nil;
+    }
+    longjmp(cx->toplevel, 1);
+}
+
+void push(Cons *p) {
+    if (cx->sp == STACK) {
+        bail("stack overflow");
+    }
+    cx->stack[cx->sp++] = p;
+}
+
+// eval, read and print nest in C for nested forms and uncompiled calls, so they bail before
+// they use up the C stack, which on the device is the main thread's
+#ifndef MBED_CONF_APP_C_STACK
+#define MBED_CONF_APP_C_STACK (256 * 1024)
+#endif
+
+void deep() {
+    if ((char *)cx->stackbase - (char *)__builtin_frame_address(0) > MBED_CONF_APP_C_STACK) {
+        bail("stack overflow");
+    }
+}
+
+// the collector marks from the symbols, the value stack and, conservatively, the C stack,
+// then sweeps every unmarked cell of the heap onto the free list
+
+// marked - test and set the mark bit of p
+bool marked(Cons *p) {
+    Page *g = page((uintptr_t)p);
+    if (g == nil) {
+        return true;
+    }
+
+    int i = p - g->cells;
+    uint32_t m = 1u << (i & 31);
+
+    if (g->marks[i >> 5] & m) {
+        return true;
+    }
+    g->marks[i >> 5] |= m;
+
+    return false;
+}
+
+void mark(Cons *p) {
+    while (true) {
+        while (pairp(p) && p->car != FREED && !marked(p)) {
+            if (p->car == VECMARK) {
+                p = _vec(p)->owner;
+                continue;
+            }
+            if (pairp(p->car)) {
+                if (cx->msp < MARKS) {
+                    cx->marks[cx->msp++] = p->car;
+                } else {
+                    cx->overflow = true;
+                }
+            }
+            p = p->cdr;
+        }
+
+        if (cx->msp == 0) {
+            return;
+        }
+        p = cx->marks[--cx->msp];
+    }
+}
+
+// scan - mark every word in [lo, hi) that points into a page
+__attribute__((no_sanitize_address))
+void scan(void **lo, void **hi) {
+    for (void **w = lo; w < hi; w++) {
+        Page *g = page((uintptr_t)*w);
+        if (g != nil) {
+            mark(&g->cells[((uintptr_t)*w - (uintptr_t)g->cells) / sizeof(Cons)]);
+        }
+    }
+}
+
+__attribute__((noinline))
+void scan_stack() {
+    jmp_buf regs;
+    setjmp(regs); // spill the callee-saved registers where scan can see them
+    scan((void **)&regs, (void **)cx->stackbase);
+}
+
+void sweep() {
+    cx->freelist = nil;
+    cx->cellsfree = 0;
+
+    for (int j = cx->npages - 1; 0 <= j; j--) {
+        Page *g = cx->pages[j];
+        for (int i = PAGE - 1; 0 <= i; i--) {
+            if (!(g->marks[i >> 5] & (1u << (i & 31)))) {
+                if (vectorp(&g->cells[i])) {
+                    unvector(&g->cells[i]);
+                }
+                g->frozen[i >> 5] &= ~(1u << (i & 31));
+                g->cells[i].car = FREED;
+                g->cells[i].cdr = cx->freelist;
+                cx->freelist = &g->cells[i];
+                cx->cellsfree++;
+            }
+        }
+        memset(g->marks, 0, sizeof(g->marks));
+    }
+}
+
+void markcode(Code *c) {
+    if (c != nil) {
+        for (int i = 0; i < c->nconsts; i++) {
+            mark(c->consts[i]);
+        }
+    }
+}
+
+// quoted data is hash-consed as it is read: bottom up, each cell of a quoted list is replaced by
+// the cell with the same car and cdr where there is one, so that equal constants share their
+// cells; shared cells are frozen, rplaca and rplacd refuse them and DEFUN copies a frozen form
+// before resolve rewrites it; the table does not keep its cells alive, gc drops the dead ones
+const unsigned SHARED = 64; // slots of the table when it is first made
+
+bool frozen(Cons *p) {
+    Page *g = pairp(p) ? page((uintptr_t)p) : nil;
+    if (g == nil) {
+        return false;
+    }
+    int i = p - g->cells;
+    return (g->frozen[i >> 5] & (1u << (i & 31))) != 0;
+}
+
+void freeze(Cons *p) {
+    Page *g = page((uintptr_t)p);
+    int i = p - g->cells;
+    g->frozen[i >> 5] |= 1u << (i & 31);
+}
+
+// cons_probe - the slot of the table holding (a . d), or the free slot where it goes
+Cons **cons_probe(Cons *a, Cons *d) {
+    uintptr_t h = (uintptr_t)a * 31 + (uintptr_t)d;
+    unsigned i = ((unsigned)(h ^ (h >> 16)) * 2654435761u) & (cx->sharecap - 1);
+
+    while (cx->shared[i] != nil && (cx->shared[i]->car != a || cx->shared[i]->cdr != d)) {
+        i = (i + 1) & (cx->sharecap - 1);
+    }
+    return &cx->shared[i];
+}
+
+// cons_rehash - move the table to cap slots, dropping the cells that are not live
+bool cons_rehash(unsigned cap, bool (*live)(Cons *)) {
+    Cons **t = new (std::nothrow) Cons *[cap]();
+    if (t == nil) {
+        return false;
+    }
+
+    Cons **old = cx->shared;
+    unsigned n = cx->sharecap;
+    cx->shared = t;
+    cx->sharecap = cap;
+    cx->sharecnt = 0;
+    for (unsigned i = 0; i < n; i++) {
+        if (old[i] != nil && live(old[i])) {
+            *cons_probe(old[i]->car, old[i]->cdr) = old[i];
+            cx->sharecnt++;
+        }
+    }
+    delete[] old;
+
+    return true;
+}
+
+bool always(Cons *p) { return true; }
+
+// hashcons - the shared cell (a . d), the fresh cell p when there is none yet
+Cons *hashcons(Cons *p, Cons *a, Cons *d) {
+    p->car = a;
+    p->cdr = d;
+    freeze(p);
+    if (cx->sharecap < 2 * (cx->sharecnt + 1) &&
+        !cons_rehash((cx->sharecap == 0) ? SHARED : 2 * cx->sharecap, always)) {
+        return p; // out of memory, the constant is not shared
+    }
+
+    Cons **q = cons_probe(a, d);
+    if (*q == nil) {
+        *q = p;
+        cx->sharecnt++;
+    }
+    return *q;
+}
+
+// share - the hash-consed datum p, which the reader has just made; a list is reversed in place
+// and rebuilt from its end, so that only sublists nest in C
+Cons *share(Cons *p) {
+    deep();
+
+    Cons *r = nil;
+    while (pairp(p) && !vectorp(p) && !frozen(p)) {
+        Cons *next = p->cdr;
+        p->cdr = r;
+        r = p;
+        p = next;
+    }
+    while (r != nil) {
+        Cons *next = r->cdr;
+        p = hashcons(r, share(r->car), p);
+        r = next;
+    }
+
+    return p;
+}
+
+// live - whether the collection has marked p
+bool live(Cons *p) {
+    Page *g = page((uintptr_t)p);
+    int i = p - g->cells;
+    return (g->marks[i >> 5] & (1u << (i & 31))) != 0;
+}
+
+// prune - drop the cells the collection is about to free, or the whole table without the memory
+void prune() {
+    if (cx->sharecap != 0 && !cons_rehash(cx->sharecap, live)) {
+        memset(cx->shared, 0, cx->sharecap * sizeof(Cons *));
+        cx->sharecnt = 0;
+    }
+}
+
+Cons *copy(Cons *p) {
+    if (!pairp(p) || vectorp(p)) {
+        return p;
+    }
+    deep();
+    Cons *a = copy(p->car);
+    return cons(a, copy(p->cdr));
+}
+
+// thaw - replace the frozen parts of the list p by copies, where resolve and fold rewrite it,
+// for a DEFUN built from quoted data
+void thaw(Cons *p) {
+    for ( ; pairp(p); p = cdr(p)) {
+        if (frozen(cdr(p))) {
+            rplacd(p, copy(cdr(p)));
+        }
+        Cons *x = car(p);
+        if (frozen(x)) {
+            rplaca(p, copy(x));
+        } else if (pairp(x) && !vectorp(x) && _op(car(x)) != QUOTE) {
+            thaw(x);
+        }
+    }
+}
+
+void markmemo(Memo *m);
+void retire();
+
+void gc(Cons *car, Cons *cdr) {
+    unsigned t = _micros();
+
+    mark(car);
+    mark(cdr);
+    for (unsigned i = 0; i < cx->symcap; i++) { // globals and function bodies
+        if (cx->symtab[i] != nil) {
+            mark(cx->symtab[i]->value);
+            markcode(cx->symtab[i]->code);
+            markmemo(cx->symtab[i]->memo);
+        }
+    }
+    for (int i = 0; i < cx->sp; i++) {
+        mark(cx->stack[i]);
+    }
+    for (int i = 0; i < cx->csp; i++) { // running functions may have been redefined since
+        mark(cx->calls[i].frame.pars);
+        markcode(cx->calls[i].code);
+    }
+    scan_stack();
+
+    while (cx->overflow) {
+        cx->overflow = false;
+        for (int j = 0; j < cx->npages; j++) {
+            Page *g = cx->pages[j];
+            for (int i = 0; i < PAGE; i++) {
+                if (g->marks[i >> 5] & (1u << (i & 31))) {
+                    mark(g->cells[i].car);
+                    mark(g->cells[i].cdr);
+                }
+            }
+        }
+    }
+
+    prune();
+    sweep();
+    retire();
+
+    cx->gcpeak = (cx->gcpeak < cx->cells - cx->cellsfree) ? cx->cells - cx->cellsfree : cx->gcpeak;
+    cx->gclast = _micros() - t;
+    cx->gcmax = (cx->gcmax < cx->gclast) ? cx->gclast : cx->gcmax;
+    cx->gctotal += cx->gclast;
+    cx->gcs++;
+}
+
+void gcstats() {
+    _puts("gc: ");
+    _putn(cx->gcs);
+    _puts(" collections, ");
+    _putn(cx->cellsfree);
+    _putc('/');
+    _putn(cx->cells);
+    _puts(" cells free, last ");
+    _putn(cx->gclast);
+    _puts("us, max ");
+    _putn(cx->gcmax);
+    _puts("us, total ");
+    _putn(cx->gctotal);
+    _puts("us\n");
+}
+
+void room() {
+    _puts("heap: ");
+    _putn(cx->npages);
+    _putc('/');
+    _putn(PAGES);
+    _puts(" pages of ");
+    _putn(PAGE);
+    _puts(" cells, ");
+    _putn(cx->cells - cx->cellsfree);
+    _puts(" used, ");
+    _putn(cx->cellsfree);
+    _puts(" free, ");
+    _putn(cx->allocs);
+    _puts(" allocated\n");
+}
+
+// bytecode, operands follow the opcode: k is a const index, n a count, a a 16-bit
+// (depth << 8 | index) slot address and j a 16-bit jump target, low byte first
+enum {
+    OP_NIL, OP_T,
+    OP_INT,     // n: small number
+    OP_CONST,   // k
+    OP_LOAD,    // a
+    OP_STORE,   // a
+    OP_GLOAD,   // k: look up symbol by name
+    OP_GSTORE,  // k
+    OP_POP,
+    OP_JUMP,    // j
+    OP_JNIL,    // j: pop, jump if nil
+    OP_JNNIL,   // j: pop, jump unless nil
+    OP_CALL,    // k n: call the function named k with n arguments
+    OP_TAILCALL,// k n: same, in the frame of the caller, see rebind
+    OP_APPLY,   // k j: unless the value on top is a function of values, call it on the forms k and jump
+    OP_CALLV,   // n: call the function below the n arguments
+    OP_TAILCALLV,
+    OP_RET,
+    OP_EVAL,    // k: the form k is left to eval
+    OP_ENTER,   // k: frame for the PROG locals k
+    OP_LEAVE,
+    OP_GO,      // n j: drop all but the n PROG locals and jump
+    OP_RETURN,  // n j: same, keeping the value on top
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_INC, OP_DEC, OP_LT, OP_GT,
+    OP_ZEROP, OP_NUMBERP, OP_NULL, OP_EQ, OP_ATOM, OP_NOT, OP_CAR, OP_CDR, OP_CONS,
+    OPCODES
+};
+
+// the profiler keeps a record per FUSER and per builtin, an activation per profiled call
+// in progress; inclusive time and cells count the outermost activation of a recursive call
+const int PROFILES = 128;
+const int ACTIVATIONS = 256;
+
+struct Profile {
+    const void *key; // the Symbol of a FUSER or special form, or the natives entry
+    const char *name;
+    unsigned calls;
+    unsigned cells;
+    uint64_t incl;
+    uint64_t excl;
+    int active;
+};
+
+struct Activation {
+    Profile *p; // nil when the profiles were full, the call is not recorded
+    uint64_t t;
+    uint64_t inner; // time spent in profiled calls made from here
+    unsigned allocs;
+};
+
+struct Profiler {
+    Profile profiles[PROFILES];
+    Activation activations[ACTIVATIONS];
+    int asp;
+    int lost; // calls past the top of activations, all inside the ones there
+    unsigned opcalls[OPCODES]; // opcodes run while profiling
+    uint64_t start; // when profiling started
+    unsigned allocs;
+};
+
+Profile *profile(const void *key, const char *name) {
+    Profiler *r = cx->profiler;
+    unsigned i = ((uintptr_t)key >> 3) % PROFILES;
+
+    for (int n = 0; n < PROFILES; n++, i = (i + 1) % PROFILES) {
+        if (r->profiles[i].key == key) {
+            return &r->profiles[i];
+        }
+        if (r->profiles[i].key == nil) {
+            r->profiles[i].key = key;
+            r->profiles[i].name = name;
+            return &r->profiles[i];
+        }
+    }
+
+    return nil;
+}
+
+void profile_enter(Profile *p) {
+    Profiler *r = cx->profiler;
+
+    if (r->asp == ACTIVATIONS) {
+        r->lost++;
+        return;
+    }
+
+    Activation *a = &r->activations[r->asp++];
+    a->p = p;
+    a->inner = 0;
+    a->allocs = cx->allocs;
+    if (p != nil) {
+        p->calls++;
+        p->active++;
+    }
+    a->t = _cycles();
+}
+
+void profile_leave() {
+    Profiler *r = cx->profiler;
+
+    if (r->lost != 0) {
+        r->lost--;
+        return;
+    }
+
+    Activation *a = &r->activations[--r->asp];
+    Profile *p = a->p;
+    if (p == nil) {
+        return;
+    }
+    uint64_t dt = _cycles() - a->t;
+
+    p->excl += dt - a->inner;
+    if (--p->active == 0) {
+        p->incl += dt;
+        p->cells += cx->allocs - a->allocs;
+    }
+    if (r->asp != 0) {
+        r->activations[r->asp - 1].inner += dt;
+    }
+}
+
+void profile_call(Symbol *fn) {
+    profile_enter(profile(fn, fn->name));
+}
+
+// slot - LOCAL references are resolved to (depth << 8 | index) by DEFUN
+Cons **slot(Frame *env, Cons *x) {
+    int n = _local(x);
+
+    for (int d = n >> 8; d > 0; d--) {
+        env = env->up;
+    }
+
+    return &env->slots[n & 0xff];
+}
+
+Cons *eval(Cons *x, Frame *env);
+
+Cons *evalcond(Cons *expr, Frame *env) {
+    for ( ; expr != nil; expr = cdr(expr)) {
+        if (eval(car(car(expr)), env) != nil) {
+            return eval(car(cdr(car(expr))), env);
+        }
+    }
+
+    return nil;
+}
+
+// evalargs - push the values of args
+void evalargs(Cons *args, Frame *env) {
+    for ( ; args != nil; args = cdr(args)) {
+        Cons *p = eval(car(args), env); // value of param is corresponding arg
+        push(p);
+    }
+}
+
+// bind - set up f with the values pushed from base in the slots for pars, missing ones are nil
+Frame *bind(Frame *f, Cons *pars, int base, Frame *up) {
+    f->up = up;
+    f->pars = pars;
+    f->slots = &cx->stack[base];
+
+    int n = cx->sp - base;
+
+    for (Cons *p = pars; p != nil; p = cdr(p), n--) {
+        if (n <= 0) {
+            push(nil);
+        }
+    }
+
+    return f;
+}
+
+// find_label - the statements of a PROG from the label on, or nil when it has no such label;
+// the symbols among them are labels, looked up in the PROG itself, as a label may be named
+// like a global or a builtin
+Cons *find_label(Cons *p, Cons *label) {
+    for ( ; p != nil; p = cdr(p)) {
+        if (car(p) == label) {
+            return p;
+        }
+    }
+    return nil;
+}
+
+Cons *evalprog(Cons *p, Frame *env) {
+    Cons *x = nil;
+    int base = cx->sp;
+    Frame f;
+
+    // set up parameters as locals
+    env = bind(&f, car(cdr(p)), base, env);
+    cx->progon = true;
+    cx->label = nil; // of a GO outside any PROG
+    Cons *body = cdr(cdr(p)); // the statement list
+    p = body;
+
+    while (p != nil && cx->progon) {
+        x = symbolp(car(p)) ? nil : eval(car(p), env);
+        if (cx->label == nil) {
+            p = cdr(p); // just follow regular chain of statements
+        } else {
+            // a GO in the statement, at its head or nested in it as compiled code has it; one
+            // to a label of an outer PROG leaves this one with the label still on its way
+            p = find_label(body, cx->label);
+            if (p != nil) {
+                cx->label = nil;
+            }
+        }
+    }
+
+    cx->progon = true; // in case of nested progs
+    cx->sp = base;
+    return x;
+}
+
+// lookup - find the place bound to sym, searching the frames made by bind by name
+Cons **lookup(Frame *env, Cons *sym) {
+    for ( ; env != nil; env = env->up) {
+        int i = 0;
+
+        for (Cons *p = env->pars; p != nil; p = cdr(p), i++) {
+            if (car(p) == sym) {
+                return &env->slots[i];
+            }
+        }
+    }
+
+    return &_sym(sym)->value; // unbound locally, the symbol holds the global value
+}
+
+// builtinp - whether p is one of the symbols of the image
+bool builtinp(Cons *p);
+
+// assign - where setting sym stores, a builtin cannot be set
+Cons **assign(Frame *env, Cons *sym) {
+    if (_type(sym) == LOCAL) {
+        return slot(env, sym);
+    }
+    Cons **p = lookup(env, sym);
+    if (p == &_sym(sym)->value && builtinp(sym)) {
+        bail("builtin");
+    }
+    return p;
+}
+
+// address - position of sym in the nested parameter lists of scope, or -1
+int address(Cons *scope, Cons *sym) {
+    for (int d = 0; scope != nil; scope = cdr(scope), d++) {
+        int i = 0;
+
+        for (Cons *p = car(scope); p != nil; p = cdr(p), i++) {
+            if (car(p) == sym) {
+                return (d << 8) | i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+// the reader is driven by a table of the token each character starts
+uint8_t syntax[128];
+
+void init_syntax() {
+    memset(syntax, ERR, sizeof(syntax));
+
+    for (int c = 'A'; c <= 'Z'; c++) {
+        syntax[c] = ALPHA;
+        syntax[c - 'A' + 'a'] = ALPHA;
+    }
+    for (const char *s = "!*+-./<=>?_"; *s != '\0'; s++) {
+        syntax[(int)*s] = ALPHA;
+    }
+    for (int c = '0'; c <= '9'; c++) {
+        syntax[c] = DIGIT;
+    }
+    for (const char *s = " \t\r,"; *s != '\0'; s++) {
+        syntax[(int)*s] = BLANK;
+    }
+    syntax['('] = syntax['['] = LPAREN;
+    syntax[')'] = syntax[']'] = RPAREN;
+    syntax['\''] = QUOTED;
+    syntax['"'] = STRING;
+    syntax['\n'] = EOL;
+}
+
+token_t _syntax(int c) {
+    if (c == EOF) {
+        return EOT;
+    }
+    return (0 <= c && c < 128) ? (token_t)syntax[c] : ERR;
+}
+
+// tokens are collected in a fixed buffer, the excess of an overlong one is dropped
+
+// scan - read a token of digits, or of symbol characters, into token
+void scan(token_t t) {
+    int n = 0;
+    int c;
+
+    while (true) {
+        c = _getc();
+        token_t k = _syntax(c);
+        if (k != t && !(t == ALPHA && k == DIGIT)) {
+            break;
+        }
+        if (n < TOKEN) {
+            cx->token[n++] = c;
+        }
+    }
+
+    _ungetc(c);
+    cx->token[n] = '\0';
+}
+
+Cons *vecalloc(int type, size_t size);
+
+// read_string - the characters up to the closing quote, a backslash takes the next one as is
+// but makes n and t a newline and a tab; the string grows by doubling as it is read
+Cons *read_string() {
+    _getc();
+    push(vecalloc(STR, TOKEN));
+    Cons **p = &cx->stack[cx->sp - 1];
+    int cap = TOKEN;
+    int n = 0;
+
+    for (int c; (c = _getc()) != '"' && c != EOF; ) {
+        if (c == '\\') {
+            c = _getc();
+            if (c == EOF) {
+                break;
+            }
+            c = (c == 'n') ? '\n' : (c == 't') ? '\t' : c;
+        }
+        if (n == cap) {
+            Cons *q = vecalloc(STR, 2 * cap);
+            memcpy(_vec(q)->data, _vec(*p)->data, n);
+            *p = q;
+            cap *= 2;
+        }
+        _vec(*p)->data[n++] = c;
+    }
+
+    _vec(*p)->n = n;
+    cx->sp--;
+    return *p;
+}
+
+// read_number - digits are a fixnum, or a float when there are more than fit or a fraction
+Cons *read_number() {
+    char s[2 * TOKEN + 2];
+
+    scan(DIGIT);
+    strcpy(s, cx->token);
+
+    int c = _getc();
+    if (c != '.') {
+        _ungetc(c);
+        errno = 0;
+        long long n = strtoll(s, nil, 10);
+        if (errno == ERANGE) { // past even a long long, the nearest float
+            return real(strtof(s, nil));
+        }
+        return integer(n);
+    }
+
+    scan(DIGIT);
+    strcat(s, ".");
+    strcat(s, cx->token);
+
+    return real(strtof(s, nil));
+}
+
+Cons *read_symbol() {
+    scan(ALPHA);
+    return intern(cx->token);
+}
+
+token_t read_token() {
+    while (true) {
+        int c = _getc();
+        token_t t = _syntax(c);
+
+        if (t != BLANK) {
+            _ungetc(c);
+            return t;
+        }
+    }
+}
+
+Cons *eq(Cons *x, Cons *y) {
+    if (x == nil || y == nil) {
+        if (x == y) {
+            return cx->TRUE;
+        }
+    } else if (symbolp(x) && x == y) {
+        return cx->TRUE;
+    }
+
+    return nil;
+}
+
+Cons *atom(Cons *x) {
+    if (x == nil) {
+        return cx->TRUE;
+    }
+    int typ = _type(x);
+    if (typ == NUMBER || typ == SYMBOL || vectorp(x)) {
+         return cx->TRUE;
+    }
+    return nil;
+}
+
+Cons *_and(Cons *x, Frame *env) {
+    for (Cons *p = cdr(x); p != nil; p = cdr(p)) {
+        if (eval(car(p), env) == nil) {
+            return nil;
+        }
+    }
+    return cx->TRUE;
+}
+
+Cons *_or(Cons *x, Frame *env) {
+    for (Cons *p = cdr(x); p != nil; p = cdr(p)) {
+        if (eval(car(p), env) != nil) {
+            return cx->TRUE;
+        }
+    }
+    return nil;
+}
+
+Cons *_list(Cons *x) {
+    Cons *q = nil;
+
+    for (Cons *p = cdr(x); p != nil; p = cdr(p)) {
+        q = cons(q, car(p));
+    }
+
+    return q;
+}
+
+// resolve - turn references to parameters in the expressions of a DEFUN body into LOCAL
+// frame slots, scope is the list of parameter lists visible at p, innermost first
+void resolve(Cons *p, Cons *scope) {
+    for ( ; p != nil; p = cdr(p)) {
+        Cons *x = car(p);
+
+        if (symbolp(x)) {
+            int n = address(scope, x);
+            if (n != -1) {
+                rplaca(p, local(n));
+            }
+        } else if (pairp(x)) {
+            switch (_op(car(x))) {
+                case QUOTE:
+                case DEFUN:
+                case GO:
+                    break;
+
+                case PROG:
+                    resolve(cdr(cdr(x)), cons(car(cdr(x)), scope));
+                    break;
+
+                default:
+                    resolve(x, scope);
+                    break;
+            }
+        }
+    }
+}
+
+// append - add q to the list being read, whose first and last cells are on top of the stack
+void append(Cons *q) {
+    Cons *r = cons(q, nil);
+
+    if (cx->stack[cx->sp - 1] == nil) {
+        cx->stack[cx->sp - 2] = r;
+    } else {
+        rplacd(cx->stack[cx->sp - 1], r);
+    }
+    cx->stack[cx->sp - 1] = r;
+}
+
+// quoted - share the datum of q if it is a quote, now that it is read
+void quoted(Cons *q) {
+    if (_op(car(q)) == QUOTE && pairp(cdr(q))) {
+        rplaca(cdr(q), share(car(cdr(q))));
+    }
+}
+
+// quoting - whether the list being read is a quote still waiting for its element
+bool quoting(int base) {
+    return base + 2 < cx->sp && car(cx->stack[cx->sp - 2]) == cx->TICK;
+}
+
+// read - the elements of a list up to its closing paren, across newlines; the lists being read
+// nest on the value stack instead of in C, a quote is read as a list that closes by itself
+Cons *read() {
+    int base = cx->sp;
+    push(nil);
+    push(nil);
+
+    while (true) {
+        token_t t = read_token();
+
+        switch (t) {
+            case LPAREN:
+                _getc();
+                push(nil);
+                push(nil);
+                continue;
+
+            case QUOTED:
+                _getc();
+                push(nil);
+                push(nil);
+                append(cx->TICK);
+                continue;
+
+            case ALPHA:
+                append(read_symbol());
+                break;
+
+            case DIGIT:
+                append(read_number());
+                break;
+
+            case STRING:
+                append(read_string());
+                break;
+
+            case RPAREN:
+            case EOT:
+                if (quoting(base)) {
+                    append(nil);
+                    break;
+                }
+                if (t == RPAREN) {
+                    _getc();
+                }
+                cx->sp -= 2;
+                quoted(cx->stack[cx->sp]);
+                if (cx->sp == base) {
+                    return cx->stack[base];
+                }
+                append(cx->stack[cx->sp]);
+                break;
+
+            default:
+                _getc();
+                continue;
+        }
+
+        while (quoting(base) && cx->stack[cx->sp - 2] != cx->stack[cx->sp - 1]) {
+            cx->sp -= 2;
+            quoted(cx->stack[cx->sp]);
+            append(cx->stack[cx->sp]);
+        }
+    }
+}
+
+// print - follows the chain of a list, only sublists nest
+void print(Cons *p) {
+    deep();
+
+    for ( ; p != nil; p = cdr(p)) {
+        int t = _type(p);
+
+        if (vectorp(p) && _vec(p)->type == STR) {
+            const char *s = (const char *)_vec(p)->data;
+            int at = 0; // written up to here, the text is written in runs between escapes
+            _putc('"');
+            for (int i = 0; i < _vec(p)->n; i++) {
+                if (s[i] == '"' || s[i] == '\\') {
+                    _write(&s[at], i - at);
+                    _putc('\\');
+                    at = i;
+                }
+            }
+            _write(&s[at], _vec(p)->n - at);
+            _putc('"');
+            return;
+        } else if (vectorp(p)) {
+            _puts("#<");
+            _puts(VECTYPES[_vec(p)->type]);
+            _putc(' ');
+            _putn(_vec(p)->n);
+            _putc('>');
+            return;
+        } else if (t == NUMBER && realp(p)) {
+            _putf(_real(p));
+            return;
+        } else if (t == NUMBER) {
+            _putn(_number(p));
+            return;
+        } else if (t == SYMBOL) {
+            _puts(_symbol(p));
+            return;
+        } else if (t != LIST) {
+            _puts("\033[31m" "?" "\033[0m");
+            return;
+        }
+
+        if (_type(car(p)) == LIST && !vectorp(car(p))) {
+            _putc('(');
+            print(car(p));
+            _putc(')');
+        } else {
+            print(car(p));
+        }
+    }
+}
+
+// the builtin functions are natives, they get their arguments on the value stack
+Cons *truth(bool b) { return b ? cx->TRUE : nil; }
+
+// arithmetic - fixnums are worked in long long and checked for range, where they do not fit
+// or an operand is a float the operation is done in single precision, on the FPU of the device;
+// the VM calls these on the operands of its arithmetic opcodes
+float tofloat(Cons *p) {
+    if (fixnump(p)) {
+        return (float)_number(p);
+    } else if (!realp(p)) {
+        bail("not a number");
+    }
+    return _real(p);
+}
+
+Cons *add(Cons *a, Cons *b) {
+    if (fixnump(a) && fixnump(b)) {
+        return integer((long long)_number(a) + _number(b));
+    }
+    return real(tofloat(a) + tofloat(b));
+}
+
+Cons *sub(Cons *a, Cons *b) {
+    if (fixnump(a) && fixnump(b)) {
+        return integer((long long)_number(a) - _number(b));
+    }
+    return real(tofloat(a) - tofloat(b));
+}
+
+Cons *mul(Cons *a, Cons *b) {
+    if (fixnump(a) && fixnump(b)) {
+        return integer((long long)_number(a) * _number(b));
+    }
+    return real(tofloat(a) * tofloat(b));
+}
+
+Cons *quot(Cons *a, Cons *b) {
+    if (b == number(0) || (realp(b) && _real(b) == 0)) {
+        bail("divide by zero");
+    }
+    if (fixnump(a) && fixnump(b)) {
+        return integer((long long)_number(a) / _number(b));
+    }
+    return real(tofloat(a) / tofloat(b));
+}
+
+bool less(Cons *a, Cons *b) {
+    if (fixnump(a) && fixnump(b)) {
+        return _number(a) < _number(b);
+    }
+    return tofloat(a) < tofloat(b);
+}
+
+bool zerop(Cons *p) { return p == number(0) || (realp(p) && _real(p) == 0); }
+
+// fold - the arguments combined left to right by f, (op) is base and (op x) is (op base x)
+Cons *fold(Cons *(*f)(Cons *, Cons *), Cons *base, Cons **a, int n) {
+    if (n == 0) {
+        return base;
+    }
+
+    Cons *p = (n == 1) ? f(base, a[0]) : a[0];
+    for (int i = 1; i < n; i++) {
+        p = f(p, a[i]);
+    }
+    return p;
+}
+
+Cons *_add1(Cons **a, int n) { return add(a[0], number(1)); }
+Cons *_sub1(Cons **a, int n) { return sub(a[0], number(1)); }
+Cons *_plus(Cons **a, int n) { return fold(add, number(0), a, n); }
+Cons *_diff(Cons **a, int n) { return fold(sub, number(0), a, n); }
+Cons *_times(Cons **a, int n) { return fold(mul, number(1), a, n); }
+Cons *_quot(Cons **a, int n) { return fold(quot, number(1), a, n); }
+Cons *_lessp(Cons **a, int n) { return truth(less(a[0], a[1])); }
+Cons *_greaterp(Cons **a, int n) { return truth(less(a[1], a[0])); }
+Cons *_zerop(Cons **a, int n) { return truth(zerop(a[0])); }
+
+Cons *_float(Cons **a, int n) { return real(tofloat(a[0])); }
+
+Cons *_fix(Cons **a, int n) {
+    if (fixnump(a[0])) {
+        return a[0];
+    }
+    float f = tofloat(a[0]);
+    if (!((float)FIXMIN <= f && f < -(float)FIXMIN)) { // FIXMAX rounds up to 2^n as a float
+        bail("overflow");
+    }
+    return number((int)f);
+}
+
+// Q15 fixed point: fractions in [-1, 1) as fixnums scaled by 2^15, saturated like the SSAT of
+// the DSP instructions
+const int Q15 = 1 << 15;
+
+Cons *saturate(long long n) { return number((n < -Q15) ? -Q15 : (Q15 - 1 < n) ? Q15 - 1 : (int)n); }
+
+Cons *_q15(Cons **a, int n) {
+    float f = tofloat(a[0]) * Q15;
+    return saturate((f < -2 * Q15) ? -2 * Q15 : (2 * Q15 < f) ? 2 * Q15 : (long long)f);
+}
+
+Cons *_q15_float(Cons **a, int n) { return real(tofloat(a[0]) / Q15); }
+
+Cons *_q15_mul(Cons **a, int n) {
+    if (!fixnump(a[0]) || !fixnump(a[1])) {
+        bail("not q15");
+    }
+    return saturate(((long long)_number(a[0]) * _number(a[1])) >> 15);
+}
+Cons *_numberp(Cons **a, int n) { return truth(_type(a[0]) == NUMBER); }
+Cons *_eq(Cons **a, int n) { return eq(a[0], a[1]); }
+Cons *_null(Cons **a, int n) { return eq(a[0], nil); }
+Cons *_atom(Cons **a, int n) { return atom(a[0]); }
+Cons *_not(Cons **a, int n) { return truth(a[0] == nil); }
+Cons *_car(Cons **a, int n) { return car(a[0]); }
+Cons *_cdr(Cons **a, int n) { return cdr(a[0]); }
+Cons *_cons(Cons **a, int n) { return cons(a[0], a[1]); }
+
+Cons *_rplaca(Cons **a, int n) {
+    if (frozen(a[0])) {
+        bail("constant");
+    }
+    if (pairp(a[0]) && !vectorp(a[0])) {
+        rplaca(a[0], a[1]);
+    }
+    return a[0];
+}
+
+Cons *_rplacd(Cons **a, int n) {
+    if (frozen(a[0])) {
+        bail("constant");
+    }
+    if (pairp(a[0]) && !vectorp(a[0])) {
+        rplacd(a[0], a[1]);
+    }
+    return a[0];
+}
+
+Cons *_read(Cons **a, int n) { return read(); }
+
+Cons *evalall(int at);
+bool textp(Cons *p);
+
+// (load "path") is nil when there is no such file; an error in the file closes it on the
+// way back to the toplevel; the path may be a string, a slice of one or a symbol
+Cons *_load(Cons **a, int n) {
+    char path[256];
+    if (symbolp(a[0])) {
+        snprintf(path, sizeof(path), "%s", _symbol(a[0]));
+    } else if (textp(a[0]) && _vec(a[0])->n < (int)sizeof(path)) {
+        memcpy(path, _vec(a[0])->data, _vec(a[0])->n);
+        path[_vec(a[0])->n] = '\0';
+    } else {
+        bail("not a path");
+    }
+
+    Source s;
+    s.file = fopen(path, "r");
+    s.at = s.n = 0;
+    if (s.file == nil) {
+        return nil;
+    }
+
+    jmp_buf toplevel;
+    memcpy(toplevel, cx->toplevel, sizeof(jmp_buf));
+    const char *was = cx->src;
+    Source *wasfile = cx->file;
+    Pushback back = cx->back;
+
+    cx->src = nil;
+    cx->file = &s;
+    cx->back.n = 0;
+
+    bool ok = (setjmp(cx->toplevel) == 0);
+    if (ok) {
+        push(nil);
+        evalall(cx->sp - 1);
+        cx->sp--;
+    }
+
+    fclose(s.file);
+    memcpy(cx->toplevel, toplevel, sizeof(jmp_buf));
+    cx->src = was;
+    cx->file = wasfile;
+    cx->back = back;
+
+    if (!ok) {
+        longjmp(cx->toplevel, 1);
+    }
+    return cx->TRUE;
+}
+
+Cons *_print(Cons **a, int n) {
+    print(a[0]);
+    _putc('\n');
+    return nil;
+}
+
+Cons *_gc(Cons **a, int n) {
+    gc(nil, nil);
+    gcstats();
+    return number(cx->cellsfree);
+}
+
+Cons *_room(Cons **a, int n) {
+    room();
+    return number(cx->cellsfree);
+}
+
+Vector novector = { I16, 0, nil, nil };
+
+Cons *tagged(Vector *v) { return (Cons *)((uintptr_t)v | FLOATTAG); }
+
+// vecalloc - a cell for a Vector with room for size bytes of elements, collecting once when
+// there is no memory for it; the cell is made first so that a failure leaks nothing
+Cons *vecalloc(int type, size_t size) {
+    Cons *p = cons(VECMARK, tagged(&novector));
+
+    char *b = new (std::nothrow) char[sizeof(Vector) + size];
+    if (b == nil) {
+        gc(p, nil);
+        b = new (std::nothrow) char[sizeof(Vector) + size];
+    }
+    if (b == nil) {
+        bail("out of memory");
+    }
+
+    Vector *v = (Vector *)b;
+    v->type = type;
+    v->n = 0;
+    v->data = (uint8_t *)(v + 1);
+    v->owner = nil;
+    p->cdr = tagged(v);
+    return p;
+}
+
+// vector - a vector of n zeros
+Cons *vector(int type, int n) {
+    if (n < 0) {
+        bail("bad length");
+    }
+
+    Cons *p = vecalloc(type, (size_t)n * VECSIZES[type]);
+    _vec(p)->n = n;
+    memset(_vec(p)->data, 0, (size_t)n * VECSIZES[type]);
+    return p;
+}
+
+// Bytes - the elements of a string or byte vector; mbed::Span on the device, and the part of
+// it used here on the host
+#if __MBED__
+typedef mbed::Span<uint8_t> Bytes;
+#else
+struct Bytes {
+    uint8_t *p;
+    ptrdiff_t n;
+
+    Bytes(uint8_t *p, ptrdiff_t n) : p(p), n(n) { }
+    uint8_t *data() const { return p; }
+    ptrdiff_t size() const { return n; }
+    Bytes subspan(ptrdiff_t at, ptrdiff_t k) const { return Bytes(p + at, k); }
+};
+#endif
+
+bool textp(Cons *p) { return vectorp(p) && (_vec(p)->type == U8 || _vec(p)->type == STR); }
+
+Bytes bytes(Cons *p) {
+    if (!textp(p)) {
+        bail("not a string");
+    }
+    return Bytes(_vec(p)->data, _vec(p)->n);
+}
+
+// slice - a vector of the type of p over b, elements of p, that keeps what owns them alive
+Cons *slice(Cons *p, Bytes b) {
+    Cons *q = vecalloc(_vec(p)->type, 0);
+    Vector *v = _vec(p);
+    Vector *w = _vec(q);
+    w->n = b.size();
+    w->data = b.data();
+    w->owner = (v->owner != nil) ? v->owner : p;
+    return q;
+}
+
+Vector *vec(Cons *p) {
+    if (!vectorp(p)) {
+        bail("not a vector");
+    }
+    return _vec(p);
+}
+
+int vecindex(Vector *v, Cons *i) {
+    if (!fixnump(i) || _number(i) < 0 || v->n <= _number(i)) {
+        bail("bad index");
+    }
+    return _number(i);
+}
+
+Cons *vref(Vector *v, int i) {
+    switch (v->type) {
+        case I16: return number(i16(v)[i]);
+        case I32: return integer(i32(v)[i]);
+        case F32: return real(f32(v)[i]);
+    }
+    return number(v->data[i]);
+}
+
+// saturate - d rounded toward zero and saturated to [lo, hi], 0 when it is not a number
+long long saturate(double d, long long lo, long long hi) {
+    return (d != d) ? 0 : (d <= lo) ? lo : (hi <= d) ? hi : (long long)d;
+}
+
+// clamp - x rounded toward zero and saturated to [lo, hi]
+long long clamp(Cons *x, long long lo, long long hi) {
+    if (!fixnump(x)) {
+        return saturate(tofloat(x), lo, hi);
+    }
+    long long k = _number(x);
+    return (k < lo) ? lo : (hi < k) ? hi : k;
+}
+
+void vset(Vector *v, int i, Cons *x) {
+    switch (v->type) {
+        case I16: i16(v)[i] = (int16_t)clamp(x, INT16_MIN, INT16_MAX); break;
+        case I32: i32(v)[i] = (int32_t)clamp(x, INT32_MIN, INT32_MAX); break;
+        case F32: f32(v)[i] = tofloat(x); break;
+        default: v->data[i] = (uint8_t)clamp(x, 0, UINT8_MAX); break;
+    }
+}
+
+// (vector 'type n) is n zeros, (vector 'type list) holds the numbers in list
+Cons *_vector(Cons **a, int n) {
+    int type = 0;
+    while (type < VECTYPES_ && !(symbolp(a[0]) && strcmp(_symbol(a[0]), VECTYPES[type]) == 0)) {
+        type++;
+    }
+    if (type == VECTYPES_) {
+        bail("bad vector type");
+    }
+
+    if (fixnump(a[1])) {
+        return vector(type, _number(a[1]));
+    }
+
+    int k = 0;
+    for (Cons *p = a[1]; pairp(p); p = cdr(p)) {
+        k++;
+    }
+    Cons *p = vector(type, k);
+    Vector *v = _vec(p);
+    Cons *q = a[1];
+    for (int i = 0; i < k; i++, q = cdr(q)) {
+        vset(v, i, car(q));
+    }
+    return p;
+}
+
+Cons *_vec_length(Cons **a, int n) { return number(vec(a[0])->n); }
+Cons *_vec_ref(Cons **a, int n) { Vector *v = vec(a[0]); return vref(v, vecindex(v, a[1])); }
+
+Cons *_vec_set(Cons **a, int n) {
+    Vector *v = vec(a[0]);
+    vset(v, vecindex(v, a[1]), a[2]);
+    return a[2];
+}
+
+Cons *_vec_list(Cons **a, int n) {
+    Vector *v = vec(a[0]);
+    Cons *p = nil;
+    push(nil);
+    for (int i = v->n - 1; 0 <= i; i--) {
+        p = cons(vref(v, i), p);
+        cx->stack[cx->sp - 1] = p;
+    }
+    cx->sp--;
+    return p;
+}
+
+// the int16 kernels use the dual 16-bit multiply-accumulate of the Cortex-M4 DSP extension,
+// and SSE2 on the host; sums are kept in 64 bits so that no capture is too long to sum
+long long dot16(const int16_t *x, const int16_t *y, int n) {
+    long long s = 0;
+    int i = 0;
+#if defined(__ARM_FEATURE_DSP)
+    for ( ; i + 2 <= n; i += 2) {
+        uint32_t a, b;
+        memcpy(&a, x + i, 4);
+        memcpy(&b, y + i, 4);
+        s = __SMLALD(a, b, s);
+    }
+#elif __SSE2__
+    // the products are widened singly, as the pair sums of PMADDWD wrap at -32768 * -32768 * 2
+    __m128d lo = _mm_setzero_pd(), hi = _mm_setzero_pd(); // exact below 2^53
+    for ( ; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(x + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(y + i));
+        __m128i pl = _mm_mullo_epi16(a, b), ph = _mm_mulhi_epi16(a, b);
+        __m128i p = _mm_unpacklo_epi16(pl, ph), q = _mm_unpackhi_epi16(pl, ph);
+        lo = _mm_add_pd(lo, _mm_add_pd(_mm_cvtepi32_pd(p), _mm_cvtepi32_pd(q)));
+        hi = _mm_add_pd(hi, _mm_add_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(p, 0x4e)),
+            _mm_cvtepi32_pd(_mm_shuffle_epi32(q, 0x4e))));
+    }
+    double d[2];
+    _mm_storeu_pd(d, _mm_add_pd(lo, hi));
+    s = (long long)d[0] + (long long)d[1];
+#endif
+    for ( ; i < n; i++) {
+        s += x[i] * y[i];
+    }
+    return s;
+}
+
+long long sum16(const int16_t *x, int n) {
+    long long s = 0;
+    int i = 0;
+#if defined(__ARM_FEATURE_DSP)
+    for ( ; i + 2 <= n; i += 2) {
+        uint32_t a;
+        memcpy(&a, x + i, 4);
+        s = __SMLALD(a, 0x00010001, s);
+    }
+#endif
+    for ( ; i < n; i++) {
+        s += x[i];
+    }
+    return s;
+}
+
+// add16 - x += y, saturating
+void add16(int16_t *x, const int16_t *y, int n) {
+    int i = 0;
+#if defined(__ARM_FEATURE_DSP)
+    for ( ; i + 2 <= n; i += 2) {
+        uint32_t a, b;
+        memcpy(&a, x + i, 4);
+        memcpy(&b, y + i, 4);
+        a = __QADD16(a, b);
+        memcpy(x + i, &a, 4);
+    }
+#elif __SSE2__
+    for ( ; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(x + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(y + i));
+        _mm_storeu_si128((__m128i *)(x + i), _mm_adds_epi16(a, b));
+    }
+#endif
+    for ( ; i < n; i++) {
+        int k = x[i] + y[i];
+        x[i] = (k < INT16_MIN) ? INT16_MIN : (INT16_MAX < k) ? INT16_MAX : k;
+    }
+}
+
+Cons *_vec_sum(Cons **a, int n) {
+    Vector *v = vec(a[0]);
+    long long s = 0;
+    float f = 0;
+
+    switch (v->type) {
+        case I16: return integer(sum16(i16(v), v->n));
+        case I32:
+            for (int i = 0; i < v->n; i++) {
+                s += i32(v)[i];
+            }
+            return integer(s);
+        case F32:
+            for (int i = 0; i < v->n; i++) {
+                f += f32(v)[i];
+            }
+            return real(f);
+    }
+    for (int i = 0; i < v->n; i++) {
+        s += v->data[i];
+    }
+    return integer(s);
+}
+
+// same - the vectors a and b, of one type and length
+Vector *same(Cons *a, Cons *b, Vector **w) {
+    Vector *v = vec(a);
+    *w = vec(b);
+    if (v->type != (*w)->type || v->n != (*w)->n) {
+        bail("vectors differ");
+    }
+    return v;
+}
+
+Cons *_vec_dot(Cons **a, int n) {
+    Vector *w;
+    Vector *v = same(a[0], a[1], &w);
+    long long s = 0;
+    float f = 0;
+
+    switch (v->type) {
+        case I16: return integer(dot16(i16(v), i16(w), v->n));
+        case I32:
+            for (int i = 0; i < v->n; i++) {
+                s += (long long)i32(v)[i] * i32(w)[i];
+            }
+            return integer(s);
+        case F32:
+            for (int i = 0; i < v->n; i++) {
+                f += f32(v)[i] * f32(w)[i];
+            }
+            return real(f);
+    }
+    for (int i = 0; i < v->n; i++) {
+        s += v->data[i] * w->data[i];
+    }
+    return integer(s);
+}
+
+// (vec-add a b) adds b into a, saturating integers
+Cons *_vec_add(Cons **a, int n) {
+    Vector *w;
+    Vector *v = same(a[0], a[1], &w);
+
+    switch (v->type) {
+        case I16:
+            add16(i16(v), i16(w), v->n);
+            break;
+        case I32:
+            for (int i = 0; i < v->n; i++) {
+                long long k = (long long)i32(v)[i] + i32(w)[i];
+                i32(v)[i] = (k < INT32_MIN) ? INT32_MIN : (INT32_MAX < k) ? INT32_MAX : k;
+            }
+            break;
+        case F32:
+            for (int i = 0; i < v->n; i++) {
+                f32(v)[i] += f32(w)[i];
+            }
+            break;
+        default:
+            for (int i = 0; i < v->n; i++) {
+                int k = v->data[i] + w->data[i];
+                v->data[i] = (UINT8_MAX < k) ? UINT8_MAX : k;
+            }
+            break;
+    }
+    return a[0];
+}
+
+// (vec-scale v k) multiplies v by k in place, saturating integers; the products are taken
+// in double, exact for the elements of an int32 vector and any fixnum k
+Cons *_vec_scale(Cons **a, int n) {
+    Vector *v = vec(a[0]);
+    double k = fixnump(a[1]) ? _number(a[1]) : tofloat(a[1]);
+
+    for (int i = 0; i < v->n; i++) {
+        switch (v->type) {
+            case I16: i16(v)[i] = (int16_t)saturate(i16(v)[i] * k, INT16_MIN, INT16_MAX); break;
+            case I32: i32(v)[i] = (int32_t)saturate(i32(v)[i] * k, INT32_MIN, INT32_MAX); break;
+            case F32: f32(v)[i] *= (float)k; break;
+            default: v->data[i] = (uint8_t)saturate(v->data[i] * k, 0, UINT8_MAX); break;
+        }
+    }
+    return a[0];
+}
+
+Cons *apply(Symbol *s, int base, Frame *env);
+
+// (vec-map f v) is a vector of the type of v holding f of each element
+Cons *_vec_map(Cons **a, int n) {
+    if (!symbolp(a[0]) || !isfunc(_sym(a[0])->type)) {
+        bail("not a function");
+    }
+    Vector *v = vec(a[1]);
+    Cons *p = vector(v->type, v->n);
+    push(p);
+
+    for (int i = 0; i < v->n; i++) {
+        int base = cx->sp;
+        push(vref(v, i));
+        vset(_vec(p), i, apply(_sym(a[0]), base, nil));
+    }
+
+    cx->sp--;
+    return p;
+}
+
+// before - whether element i of v is less than element k
+bool before(Vector *v, int i, int k) {
+    switch (v->type) {
+        case I16: return i16(v)[i] < i16(v)[k];
+        case I32: return i32(v)[i] < i32(v)[k];
+        case F32: return f32(v)[i] < f32(v)[k];
+    }
+    return v->data[i] < v->data[k];
+}
+
+// extreme - the least element of v, or the greatest when most
+Cons *extreme(Cons *p, bool most) {
+    Vector *v = vec(p);
+    if (v->n == 0) {
+        return nil;
+    }
+
+    int k = 0;
+    for (int i = 1; i < v->n; i++) {
+        if (most ? before(v, k, i) : before(v, i, k)) {
+            k = i;
+        }
+    }
+    return vref(v, k);
+}
+
+Cons *_vec_min(Cons **a, int n) { return extreme(a[0], false); }
+Cons *_vec_max(Cons **a, int n) { return extreme(a[0], true); }
+
+Cons *_vec_mean(Cons **a, int n) {
+    Vector *v = vec(a[0]);
+    if (v->n == 0) {
+        bail("divide by zero");
+    }
+    return real(tofloat(_vec_sum(a, n)) / v->n);
+}
+
+// (substr s start end) is a slice of s, to its end when end is nil; nothing is copied
+Cons *_substr(Cons **a, int n) {
+    Bytes b = bytes(a[0]);
+    int start = fixnump(a[1]) ? _number(a[1]) : -1;
+    int end = (a[2] == nil) ? (int)b.size() : fixnump(a[2]) ? _number(a[2]) : -1;
+    if (start < 0 || end < start || b.size() < end) {
+        bail("bad index");
+    }
+    return slice(a[0], b.subspan(start, end - start));
+}
+
+// (concat ...) copies strings, byte vectors and the names of symbols into a new string, or a
+// byte vector when the first is one
+Cons *_concat(Cons **a, int n) {
+    size_t size = 0;
+    for (int i = 0; i < n; i++) {
+        size += symbolp(a[i]) ? strlen(_symbol(a[i])) : bytes(a[i]).size();
+    }
+
+    Cons *p = vecalloc((0 < n && textp(a[0])) ? _vec(a[0])->type : STR, size);
+    uint8_t *d = _vec(p)->data;
+    for (int i = 0; i < n; i++) {
+        if (symbolp(a[i])) {
+            memcpy(d, _symbol(a[i]), strlen(_symbol(a[i])));
+            d += strlen(_symbol(a[i]));
+        } else {
+            memcpy(d, bytes(a[i]).data(), bytes(a[i]).size());
+            d += bytes(a[i]).size();
+        }
+    }
+    _vec(p)->n = size;
+    return p;
+}
+
+// (print-raw s) writes the bytes of s as they are
+Cons *_print_raw(Cons **a, int n) {
+    Bytes b = bytes(a[0]);
+    _write((const char *)b.data(), b.size());
+    _flush();
+    return a[0];
+}
+
+// messages carry values between contexts through mailboxes named by symbols; a value is
+// serialized a node at a time: '(' car cdr for a pair, 'n' and four bytes for a fixnum, 'f'
+// and four for a float, 's', a length and the name for a symbol, 'b', the type, a length and
+// the bytes for a string or byte vector, '.' for nil
+const int MESSAGE = 64;
+const int MAILBOXES = 4;
+const int MAIL = 4; // messages a mailbox holds
+
+struct Message {
+    int n;
+    uint8_t bytes[MESSAGE];
+};
+
+struct Mailbox {
+    char name[TOKEN + 1];
+#if __MBED__
+    rtos::Mail<Message, MAIL> mail;
+#else
+    Message mail[MAIL];
+    int head, count;
+    std::mutex lock;
+    std::condition_variable ready;
+#endif
+};
+
+Mailbox mailboxes[MAILBOXES];
+
+#if !__MBED__
+std::mutex named; // the names of the mailboxes
+#endif
+
+// mailbox - the mailbox called name, made on first use
+Mailbox *mailbox(Cons *name) {
+    if (!symbolp(name)) {
+        bail("not a mailbox");
+    }
+
+    Mailbox *b = nil;
+    {
+#if !__MBED__
+        std::lock_guard<std::mutex> hold(named);
+#endif
+        for (int i = 0; b == nil && i < MAILBOXES; i++) {
+            if (mailboxes[i].name[0] == '\0') {
+                strncpy(mailboxes[i].name, _symbol(name), TOKEN);
+            }
+            if (strncmp(mailboxes[i].name, _symbol(name), TOKEN) == 0) {
+                b = &mailboxes[i];
+            }
+        }
+    }
+
+    if (b == nil) {
+        bail("too many mailboxes");
+    }
+    return b;
+}
+
+// pack - serialize p into m, false when it does not fit
+bool pack(Message *m, Cons *p) {
+    deep();
+
+    for ( ; pairp(p) && !vectorp(p); p = cdr(p)) {
+        if (m->n == MESSAGE) {
+            return false;
+        }
+        m->bytes[m->n++] = '(';
+        if (!pack(m, car(p))) {
+            return false;
+        }
+    }
+
+    if (vectorp(p) && !textp(p)) {
+        return false;
+    }
+
+    int n = symbolp(p) ? strlen(_symbol(p)) : textp(p) ? _vec(p)->n + 1 : 0;
+    if (MESSAGE - m->n < 2 + ((n < 4) ? 4 : n)) {
+        return false;
+    }
+
+    if (fixnump(p) || realp(p)) {
+        uint32_t k = _number(p);
+        if (realp(p)) {
+            float f = _real(p);
+            memcpy(&k, &f, sizeof(k));
+        }
+        m->bytes[m->n++] = fixnump(p) ? 'n' : 'f';
+        for (int i = 0; i < 4; i++, k >>= 8) {
+            m->bytes[m->n++] = k & 0xff;
+        }
+    } else if (symbolp(p)) {
+        m->bytes[m->n++] = 's';
+        m->bytes[m->n++] = n;
+        memcpy(&m->bytes[m->n], _symbol(p), n);
+        m->n += n;
+    } else if (textp(p)) {
+        m->bytes[m->n++] = 'b';
+        m->bytes[m->n++] = _vec(p)->type;
+        m->bytes[m->n++] = _vec(p)->n;
+        memcpy(&m->bytes[m->n], _vec(p)->data, _vec(p)->n);
+        m->n += _vec(p)->n;
+    } else {
+        m->bytes[m->n++] = '.';
+    }
+
+    return true;
+}
+
+// unpack - the value serialized in m from at
+Cons *unpack(const Message *m, int *at) {
+    deep();
+
+    int base = cx->sp;
+    while (m->bytes[*at] == '(') {
+        (*at)++;
+        push(unpack(m, at));
+    }
+
+    Cons *p = nil;
+    if (m->bytes[*at] == 'n' || m->bytes[*at] == 'f') {
+        const uint8_t *b = &m->bytes[*at + 1];
+        uint32_t k = b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+        float f;
+        memcpy(&f, &k, sizeof(f));
+        p = (m->bytes[*at] == 'n') ? number((int)k) : real(f);
+        *at += 5;
+    } else if (m->bytes[*at] == 's') {
+        char name[MESSAGE];
+        int n = m->bytes[*at + 1];
+        memcpy(name, &m->bytes[*at + 2], n);
+        name[n] = '\0';
+        p = intern(name);
+        *at += 2 + n;
+    } else if (m->bytes[*at] == 'b') {
+        int n = m->bytes[*at + 2];
+        p = vector(m->bytes[*at + 1], n);
+        memcpy(_vec(p)->data, &m->bytes[*at + 3], n);
+        *at += 3 + n;
+    } else {
+        (*at)++;
+    }
+
+    while (base < cx->sp) {
+        cx->sp--;
+        p = cons(cx->stack[cx->sp], p);
+    }
+
+    return p;
+}
+
+// post - queue m, waiting while the mailbox is full
+void post(Mailbox *b, const Message *m) {
+    Context *c = idle();
+#if __MBED__
+    Message *q = b->mail.alloc_for(osWaitForever);
+    *q = *m;
+    b->mail.put(q);
+#else
+    std::unique_lock<std::mutex> hold(b->lock);
+    b->ready.wait(hold, [b] { return b->count != MAIL; });
+    b->mail[(b->head + b->count++) % MAIL] = *m;
+    b->ready.notify_all();
+#endif
+    resume(c);
+}
+
+// take - the next message, waiting for one while other contexts run
+void take(Mailbox *b, Message *m) {
+    Context *c = idle();
+#if __MBED__
+    osEvent e = b->mail.get();
+    Message *q = (Message *)e.value.p;
+    *m = *q;
+    b->mail.free(q);
+#else
+    std::unique_lock<std::mutex> hold(b->lock);
+    b->ready.wait(hold, [b] { return b->count != 0; });
+    *m = b->mail[b->head];
+    b->head = (b->head + 1) % MAIL;
+    b->count--;
+    b->ready.notify_all();
+#endif
+    resume(c);
+}
+
+Cons *_send(Cons **a, int n) {
+    Mailbox *b = mailbox(a[0]);
+    Message m;
+    m.n = 0;
+    if (!pack(&m, a[1])) {
+        bail("message too long");
+    }
+    post(b, &m);
+    return a[1];
+}
+
+Cons *_receive(Cons **a, int n) {
+    Mailbox *b = mailbox(a[0]);
+    Message m;
+    take(b, &m);
+    int at = 0;
+    return unpack(&m, &at);
+}
+
+// memoized functions keep the values of their calls in a hash table of the arguments, bounded
+// by evicting the entry used least recently; entries are chained by index in their bucket and
+// in the order of use, and the collector marks their keys and values
+const int MEMO = 64; // entries of (memoize 'f) without a capacity
+
+void recompile();
+
+struct Entry {
+    Cons *key; // list of the arguments
+    Cons *value;
+    unsigned hash;
+    int next;         // in the bucket
+    int newer, older; // in the order of use
+    bool done;        // the call has returned
+};
+
+struct Memo {
+    int cap, count;
+    int nbuckets; // a power of two
+    int *buckets;
+    Entry *entries;
+    int newest, oldest;
+    unsigned hits, misses;
+};
+
+void markmemo(Memo *m) {
+    if (m != nil) {
+        for (int i = 0; i < m->count; i++) {
+            mark(m->entries[i].key);
+            mark(m->entries[i].value);
+        }
+    }
+}
+
+void flush(Memo *m) {
+    m->count = 0;
+    m->newest = m->oldest = -1;
+    for (int i = 0; i < m->nbuckets; i++) {
+        m->buckets[i] = -1;
+    }
+}
+
+void unmemo(Symbol *s) {
+    if (s->memo != nil) {
+        delete[] s->memo->buckets;
+        delete[] s->memo->entries;
+        delete s->memo;
+        s->memo = nil;
+    }
+}
+
+// hashval - a hash of p that equal values share
+unsigned hashval(Cons *p, unsigned h) {
+    deep();
+
+    for ( ; pairp(p) && !vectorp(p); p = cdr(p)) {
+        h = hashval(car(p), (h ^ '(') * 16777619u);
+    }
+    if (textp(p)) {
+        for (int i = 0; i < _vec(p)->n; i++) {
+            h = (h ^ _vec(p)->data[i]) * 16777619u;
+        }
+        return h;
+    }
+    return (h ^ (unsigned)(uintptr_t)p ^ (unsigned)((uintptr_t)p >> 16)) * 16777619u;
+}
+
+// equal - whether p and q are the same tree, with the same text in their strings
+bool equal(Cons *p, Cons *q) {
+    deep();
+
+    for ( ; p != q; p = cdr(p), q = cdr(q)) {
+        if (textp(p) && textp(q)) {
+            return _vec(p)->type == _vec(q)->type && _vec(p)->n == _vec(q)->n &&
+                memcmp(_vec(p)->data, _vec(q)->data, _vec(p)->n) == 0;
+        }
+        if (!pairp(p) || !pairp(q) || vectorp(p) || vectorp(q) || !equal(car(p), car(q))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void unlink(Memo *m, int i) {
+    Entry *e = &m->entries[i];
+    if (e->newer != -1) {
+        m->entries[e->newer].older = e->older;
+    } else {
+        m->newest = e->older;
+    }
+    if (e->older != -1) {
+        m->entries[e->older].newer = e->newer;
+    } else {
+        m->oldest = e->newer;
+    }
+}
+
+void touch(Memo *m, int i) {
+    Entry *e = &m->entries[i];
+    e->newer = -1;
+    e->older = m->newest;
+    if (m->newest != -1) {
+        m->entries[m->newest].newer = i;
+    }
+    m->newest = i;
+    if (m->oldest == -1) {
+        m->oldest = i;
+    }
+}
+
+// evict - take the least recently used entry out of its bucket, for reuse
+int evict(Memo *m) {
+    int i = m->oldest;
+    unlink(m, i);
+
+    int *q = &m->buckets[m->entries[i].hash & (m->nbuckets - 1)];
+    while (*q != i) {
+        q = &m->entries[*q].next;
+    }
+    *q = m->entries[i].next;
+
+    return i;
+}
+
+// store - an entry for key with hash h, the newest in its bucket
+int store(Memo *m, Cons *key, unsigned h) {
+    int i = (m->count < m->cap) ? m->count++ : evict(m);
+    Entry *e = &m->entries[i];
+    e->key = key;
+    e->value = nil;
+    e->hash = h;
+    e->done = false;
+    e->next = m->buckets[h & (m->nbuckets - 1)];
+    m->buckets[h & (m->nbuckets - 1)] = i;
+    touch(m, i);
+
+    return i;
+}
+
+Cons *compute(Symbol *s, int base, Frame *env);
+
+// recall - s of the arguments from base, from the cache when it was called with them before;
+// the entry is made before the call and found again after it, as recursive calls may evict it
+Cons *recall(Symbol *s, int base, Frame *env) {
+    Memo *m = s->memo;
+    unsigned h = 2166136261u;
+    for (int i = base; i < cx->sp; i++) {
+        h = hashval(cx->stack[i], h);
+    }
+
+    for (int i = m->buckets[h & (m->nbuckets - 1)]; i != -1; i = m->entries[i].next) {
+        Entry *e = &m->entries[i];
+        if (e->done && e->hash == h) {
+            Cons *k = e->key;
+            int j = base;
+            while (j < cx->sp && pairp(k) && equal(car(k), cx->stack[j])) {
+                k = cdr(k);
+                j++;
+            }
+            if (j == cx->sp && k == nil) {
+                m->hits++;
+                unlink(m, i);
+                touch(m, i);
+                cx->sp = base;
+                if (cx->profiling) { // a call all the same
+                    profile_call(s);
+                    profile_leave();
+                }
+                return e->value;
+            }
+        }
+    }
+
+    m->misses++;
+    Cons *key = nil;
+    for (int i = cx->sp - 1; base <= i; i--) {
+        key = cons(cx->stack[i], key);
+    }
+    int i = store(m, key, h);
+
+    Cons *x = compute(s, base, env);
+
+    if (s->memo == m) {
+        if (m->count <= i || m->entries[i].key != key) {
+            i = store(m, key, h);
+        }
+        m->entries[i].value = x;
+        m->entries[i].done = true;
+    }
+    return x;
+}
+
+// (memoize 'f capacity) caches the calls of f, in capacity entries or MEMO when that is nil;
+// a capacity of 0 stops caching
+Cons *_memoize(Cons **a, int n) {
+    if (!symbolp(a[0]) || _sym(a[0])->type != FUSER) {
+        bail("not a function");
+    }
+    int cap = (a[1] == nil) ? MEMO : fixnump(a[1]) ? _number(a[1]) : -1;
+    if (cap < 0) {
+        bail("bad capacity");
+    }
+
+    Symbol *s = _sym(a[0]);
+    unmemo(s);
+    if (cap == 0) {
+        return nil;
+    }
+
+    Memo *m = new Memo();
+    m->cap = cap;
+    m->nbuckets = 1;
+    while (m->nbuckets < cap) {
+        m->nbuckets *= 2;
+    }
+    m->buckets = new int[m->nbuckets];
+    m->entries = new Entry[cap];
+    flush(m);
+    s->memo = m;
+    if (s->inlined) { // its calls are to go through the cache
+        s->inlined = false;
+        recompile();
+    }
+
+    return a[0];
+}
+
+// (memo-stats 'f) is (hits misses entries capacity), nil unless f is memoized
+Cons *_memo_stats(Cons **a, int n) {
+    if (!symbolp(a[0]) || _sym(a[0])->memo == nil) {
+        return nil;
+    }
+
+    Memo *m = _sym(a[0])->memo;
+    Cons *p = cons(number(m->cap), nil);
+    p = cons(number(m->count), p);
+    p = cons(integer(m->misses), p);
+    return cons(integer(m->hits), p);
+}
+
+// images - (save-image) writes the symbols a program has set or defined to a file, with their
+// values and function bodies, and (load-image) reads them back and compiles the functions
+// again; values are written as in messages, with 'l' and four bytes for a local slot
+// reference and 'V', the type, length and elements for a vector, so an image holds no
+// addresses and loads into any context
+#ifndef MBED_CONF_APP_IMAGE_PATH
+#if __MBED__
+#define MBED_CONF_APP_IMAGE_PATH "/fs/cortex.img"
+#else
+#define MBED_CONF_APP_IMAGE_PATH "cortex.img"
+#endif
+#endif
+
+const char MAGIC[] = "CXI1";
+
+Code *compile_body(Cons *body);
+void release(Code *c);
+
+void put4(FILE *f, uint32_t k) {
+    for (int i = 0; i < 4; i++, k >>= 8) {
+        fputc(k & 0xff, f);
+    }
+}
+
+uint32_t get4(FILE *f) {
+    uint32_t k = 0;
+    for (int i = 0; i < 4; i++) {
+        k |= (uint32_t)(fgetc(f) & 0xff) << (8 * i);
+    }
+    return k;
+}
+
+void putname(FILE *f, const char *s) {
+    int n = strlen(s);
+    if (255 < n) {
+        bail("name too long");
+    }
+    fputc(n, f);
+    fwrite(s, 1, n, f);
+}
+
+Cons *getname(FILE *f) {
+    char name[256];
+    int n = fgetc(f) & 0xff;
+    if (fread(name, 1, n, f) != (size_t)n) {
+        bail("bad image");
+    }
+    name[n] = '\0';
+    return intern(name);
+}
+
+// dump - write p, a list that goes on for more cells than the heap has is circular
+void dump(FILE *f, Cons *p, int *cells) {
+    deep();
+
+    for ( ; pairp(p) && !vectorp(p); p = cdr(p)) {
+        if (--*cells < 0) {
+            bail("circular");
+        }
+        fputc('(', f);
+        dump(f, car(p), cells);
+    }
+
+    if (vectorp(p)) {
+        Vector *v = _vec(p);
+        fputc('V', f);
+        fputc(v->type, f);
+        put4(f, v->n);
+        fwrite(v->data, VECSIZES[v->type], v->n, f);
+    } else if (fixnump(p)) {
+        fputc('n', f);
+        put4(f, _number(p));
+    } else if (realp(p)) {
+        float r = _real(p);
+        uint32_t k;
+        memcpy(&k, &r, sizeof(k));
+        fputc('f', f);
+        put4(f, k);
+    } else if (symbolp(p)) {
+        fputc('s', f);
+        putname(f, _symbol(p));
+    } else if (p != nil) {
+        fputc('l', f);
+        put4(f, _local(p));
+    } else {
+        fputc('.', f);
+    }
+}
+
+Cons *undump(FILE *f) {
+    deep();
+
+    int base = cx->sp;
+    int c;
+    while ((c = fgetc(f)) == '(') {
+        push(undump(f));
+    }
+
+    Cons *p = nil;
+    switch (c) {
+        case 'n': p = number((int)get4(f)); break;
+        case 's': p = getname(f); break;
+        case 'l': p = local(get4(f)); break;
+        case 'V': {
+            int type = fgetc(f);
+            if (type < I16 || VECTYPES_ <= type) {
+                bail("bad image");
+            }
+            int n = get4(f);
+            p = vector(type, n);
+            if (fread(_vec(p)->data, VECSIZES[type], n, f) != (size_t)n) {
+                bail("bad image");
+            }
+            break;
+        }
+        case 'f': {
+            uint32_t k = get4(f);
+            float r;
+            memcpy(&r, &k, sizeof(r));
+            p = real(r);
+            break;
+        }
+        case '.': break;
+        default: bail("bad image");
+    }
+
+    while (base < cx->sp) {
+        cx->sp--;
+        p = cons(cx->stack[cx->sp], p);
+    }
+
+    return p;
+}
+
+// saved - whether save-image writes s: variables that are set and user functions
+bool saved(Symbol *s) {
+    return s != nil && !builtinp((Cons *)((uintptr_t)s + SYMTAG)) &&
+        ((s->type == VAR && s->value != nil) || s->type == FUSER);
+}
+
+// the image is written beside the old one and renamed over it, so that a failed save leaves
+// the old image; bail closes the file of a failed save or load
+Cons *_save_image(Cons **a, int n) {
+    cx->image = fopen(MBED_CONF_APP_IMAGE_PATH "~", "wb");
+    if (cx->image == nil) {
+        bail("can't save image");
+    }
+
+    fwrite(MAGIC, 1, 4, cx->image);
+    for (unsigned i = 0; i < cx->symcap; i++) {
+        Symbol *s = cx->symtab[i];
+        if (saved(s)) {
+            int cells = cx->cells;
+            fputc((s->type == FUSER) ? 'f' : 'v', cx->image);
+            putname(cx->image, s->name);
+            dump(cx->image, s->value, &cells);
+        }
+    }
+    fputc('.', cx->image);
+
+    bool ok = (ferror(cx->image) == 0);
+    ok = (fclose(cx->image) == 0) && ok;
+    cx->image = nil;
+    if (!ok || rename(MBED_CONF_APP_IMAGE_PATH "~", MBED_CONF_APP_IMAGE_PATH) != 0) {
+        remove(MBED_CONF_APP_IMAGE_PATH "~");
+        bail("can't save image");
+    }
+
+    return cx->TRUE;
+}
+
+// (load-image) is nil when there is no image; the functions are compiled once all of them
+// are read, as a call compiles differently when it is to a function
+Cons *_load_image(Cons **a, int n) {
+    char magic[4];
+
+    cx->image = fopen(MBED_CONF_APP_IMAGE_PATH, "rb");
+    if (cx->image == nil) {
+        return nil;
+    }
+    if (fread(magic, 1, 4, cx->image) != 4 || memcmp(magic, MAGIC, 4) != 0) {
+        bail("bad image");
+    }
+
+    int c;
+    bool stale = false; // a function inlined into others is redefined
+    while ((c = fgetc(cx->image)) == 'v' || c == 'f') {
+        Cons *sym = getname(cx->image);
+        if (builtinp(sym)) {
+            bail("builtin");
+        }
+        Symbol *s = _sym(sym);
+        stale = stale || s->inlined;
+        s->inlined = false;
+        s->value = undump(cx->image);
+        if (s->type == FUSER) {
+            release(s->code);
+            s->code = nil;
+        }
+        if (s->memo != nil && c == 'f') {
+            flush(s->memo);
+        } else {
+            unmemo(s);
+        }
+        s->type = (c == 'f') ? FUSER : VAR;
+    }
+
+    fclose(cx->image);
+    cx->image = nil;
+    if (c != '.') {
+        bail("bad image");
+    }
+
+    if (stale) {
+        recompile();
+    }
+    for (unsigned i = 0; i < cx->symcap; i++) {
+        Symbol *s = cx->symtab[i];
+        if (saved(s) && s->type == FUSER && s->code == nil) {
+            s->code = compile_body(car(cdr(s->value)));
+        }
+    }
+
+    return cx->TRUE;
+}
+
+// natives - the builtin functions; arguments are padded with nil or cut to the arity unless
+// that is -1, and a call compiles to op unless that is -1; a call of a variadic native with an op
+// needs two arguments or more and compiles to a chain of op; a pure native may be called by
+// the compiler on the constant arguments of a call
+struct Builtin {
+    const char *name;
+    Native fn;
+    int arity;
+    int op;
+    bool quoted; // the arguments are passed unevaluated
+    bool pure;   // no effects, a call on constants folds at DEFUN
+};
+
+const Builtin natives[] = {
+    { "add1", _add1, 1, OP_INC, false, true },
+    { "sub1", _sub1, 1, OP_DEC, false, true },
+    { "plus", _plus, -1, OP_ADD, false, true },
+    { "diff", _diff, -1, OP_SUB, false, true },
+    { "times", _times, -1, OP_MUL, false, true },
+    { "quot", _quot, -1, OP_DIV, false, true },
+    { "lessp", _lessp, 2, OP_LT, false, true },
+    { "greaterp", _greaterp, 2, OP_GT, false, true },
+    { "zerop", _zerop, 1, OP_ZEROP, false, true },
+    { "numberp", _numberp, 1, OP_NUMBERP, false, true },
+    { "eq", _eq, 2, OP_EQ, false, true },
+    { "null", _null, 1, OP_NULL, false, true },
+    { "atom", _atom, 1, OP_ATOM, false, true },
+    { "not", _not, 1, OP_NOT, false, true },
+    { "car", _car, 1, OP_CAR, false, false },
+    { "cdr", _cdr, 1, OP_CDR, false, false },
+    { "cons", _cons, 2, OP_CONS, false, false },
+    { "rplaca", _rplaca, 2, -1, false, false },
+    { "rplacd", _rplacd, 2, -1, false, false },
+    { "read", _read, 0, -1, false, false },
+    { "print", _print, 1, -1, false, false },
+    { "gc", _gc, 0, -1, false, false },
+    { "room", _room, 0, -1, false, false },
+    { "send", _send, 2, -1, false, false },
+    { "receive", _receive, 1, -1, false, false },
+    { "save-image", _save_image, 0, -1, false, false },
+    { "load-image", _load_image, 0, -1, false, false },
+    { "load", _load, 1, -1, false, false },
+    { "float", _float, 1, -1, false, true },
+    { "fix", _fix, 1, -1, false, true },
+    { "q15", _q15, 1, -1, false, true },
+    { "q15-float", _q15_float, 1, -1, false, true },
+    { "q15*", _q15_mul, 2, -1, false, true },
+    { "vector", _vector, 2, -1, false, false },
+    { "vec-length", _vec_length, 1, -1, false, false },
+    { "vec-ref", _vec_ref, 2, -1, false, false },
+    { "vec-set", _vec_set, 3, -1, false, false },
+    { "vec-list", _vec_list, 1, -1, false, false },
+    { "vec-sum", _vec_sum, 1, -1, false, false },
+    { "vec-dot", _vec_dot, 2, -1, false, false },
+    { "vec-add", _vec_add, 2, -1, false, false },
+    { "vec-scale", _vec_scale, 2, -1, false, false },
+    { "vec-map", _vec_map, 2, -1, false, false },
+    { "vec-min", _vec_min, 1, -1, false, false },
+    { "vec-max", _vec_max, 1, -1, false, false },
+    { "vec-mean", _vec_mean, 1, -1, false, false },
+    { "substr", _substr, 3, -1, false, false },
+    { "concat", _concat, -1, -1, false, false },
+    { "print-raw", _print_raw, 1, -1, false, false },
+    { "memoize", _memoize, 2, -1, false, false },
+    { "memo-stats", _memo_stats, 1, -1, false, false },
+};
+
+const int NATIVES = sizeof(natives) / sizeof(natives[0]);
+
+#define FORM(name, t) { name, nil, t, nil, nil, nil, false }
+#define NATIVE(name, i) { name, nil, FNATIVE, nil, &natives[i], nil, false }
+
+// image - the symbols of the builtins, const so that they stay in flash and are shared by
+// every context; a context enters them in its symbol table, and may only shadow them
+const Symbol image[] = {
+    { "t", (Cons *)((uintptr_t)&image[0] + SYMTAG), T, nil, nil, nil, false },
+    FORM("quote", QUOTE), FORM("'", QUOTE),
+    FORM("nil", NIL),
+    FORM("and", FAND),
+    FORM("or", FOR),
+    FORM("apply", FAPPLY),
+    FORM("funcall", FUNCALL),
+    FORM("cond", COND),
+    FORM("defun", DEFUN), FORM("defn", DEFUN),
+    FORM("eval", FEVAL),
+    FORM("go", GO),
+    FORM("profile", FPROFILE),
+    FORM("prog", PROG),
+    FORM("return", RETRN),
+    FORM("setq", FSETQ),
+    NATIVE("add1", 0), NATIVE("inc", 0),
+    NATIVE("sub1", 1), NATIVE("dec", 1),
+    NATIVE("plus", 2), NATIVE("+", 2),
+    NATIVE("diff", 3), NATIVE("-", 3),
+    NATIVE("times", 4), NATIVE("*", 4),
+    NATIVE("quot", 5), NATIVE("/", 5),
+    NATIVE("lessp", 6), NATIVE("<", 6),
+    NATIVE("greaterp", 7), NATIVE(">", 7),
+    NATIVE("zerop", 8), NATIVE("zero?", 8),
+    NATIVE("numberp", 9), NATIVE("number?", 9),
+    NATIVE("eq", 10), NATIVE("=", 10),
+    NATIVE("null", 11), NATIVE("nil?", 11),
+    NATIVE("atom", 12),
+    NATIVE("not", 13),
+    NATIVE("car", 14), NATIVE("first", 14),
+    NATIVE("cdr", 15), NATIVE("next", 15),
+    NATIVE("cons", 16),
+    NATIVE("rplaca", 17),
+    NATIVE("rplacd", 18),
+    NATIVE("read", 19),
+    NATIVE("print", 20),
+    NATIVE("gc", 21),
+    NATIVE("room", 22),
+    NATIVE("send", 23),
+    NATIVE("receive", 24),
+    NATIVE("save-image", 25),
+    NATIVE("load-image", 26),
+    NATIVE("load", 27),
+    NATIVE("float", 28),
+    NATIVE("fix", 29),
+    NATIVE("q15", 30),
+    NATIVE("q15-float", 31),
+    NATIVE("q15*", 32),
+    NATIVE("vector", 33),
+    NATIVE("vec-length", 34), NATIVE("buf-length", 34),
+    NATIVE("vec-ref", 35), NATIVE("buf-ref", 35),
+    NATIVE("vec-set", 36), NATIVE("buf-set", 36),
+    NATIVE("vec-list", 37),
+    NATIVE("vec-sum", 38),
+    NATIVE("vec-dot", 39),
+    NATIVE("vec-add", 40),
+    NATIVE("vec-scale", 41),
+    NATIVE("vec-map", 42),
+    NATIVE("vec-min", 43),
+    NATIVE("vec-max", 44),
+    NATIVE("vec-mean", 45),
+    NATIVE("substr", 46),
+    NATIVE("concat", 47),
+    NATIVE("print-raw", 48),
+    NATIVE("memoize", 49),
+    NATIVE("memo-stats", 50),
+};
+
+#undef FORM
+#undef NATIVE
+
+const int IMAGE = sizeof(image) / sizeof(image[0]);
+
+bool builtinp(Cons *p) { return symbolp(p) && image <= _sym(p) && _sym(p) < image + IMAGE; }
+
+// form - the symbol a special form is profiled as, the first of its names
+Symbol *form(int op) {
+    int i = 0;
+    while (image[i].type != op) {
+        i++;
+    }
+    return (Symbol *)&image[i];
+}
+
+// constant folding - DEFUN replaces the calls of pure natives on numbers, t and nil in a body
+// by their values, innermost first; a call that bails is kept to bail when it runs
+
+bool constantp(Cons *x) {
+    return x == nil || _type(x) == NUMBER || x == cx->TRUE || (symbolp(x) && _op(x) == NIL);
+}
+
+bool foldable(Cons *x) {
+    if (_op(car(x)) != FNATIVE || !_sym(car(x))->native->pure) {
+        return false;
+    }
+    for (Cons *p = cdr(x); p != nil; p = cdr(p)) {
+        if (!constantp(car(p))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// evaluate - the value of the foldable call x, or x where it bails
+Cons *evaluate(Cons *x) {
+    const Builtin *b = _sym(car(x))->native;
+    jmp_buf toplevel;
+    memcpy(toplevel, cx->toplevel, sizeof(jmp_buf));
+    const char *error = cx->error;
+    int base = cx->sp;
+    Cons *p = x;
+
+    cx->folding = true;
+    if (setjmp(cx->toplevel) == 0) {
+        for (Cons *q = cdr(x); q != nil; q = cdr(q)) {
+            push(symbolp(car(q)) ? _sym(car(q))->value : car(q));
+        }
+        while (cx->sp - base < b->arity) {
+            push(nil);
+        }
+        p = b->fn(&cx->stack[base], (0 <= b->arity) ? b->arity : cx->sp - base);
+    }
+    cx->folding = false;
+
+    memcpy(cx->toplevel, toplevel, sizeof(jmp_buf));
+    cx->error = error;
+    cx->sp = base;
+    return p;
+}
+
+// fold - the expressions of the list p, the way resolve walks them
+void fold(Cons *p) {
+    for ( ; p != nil; p = cdr(p)) {
+        Cons *x = car(p);
+        if (!pairp(x) || vectorp(x)) {
+            continue;
+        }
+
+        switch (_op(car(x))) {
+            case QUOTE:
+            case DEFUN:
+            case GO:
+                break;
+
+            case PROG:
+                fold(cdr(cdr(x)));
+                break;
+
+            case COND:
+                for (Cons *q = cdr(x); q != nil; q = cdr(q)) {
+                    fold(car(q));
+                }
+                break;
+
+            default: // not the head, which a LIST form evaluates as a form of its own
+                fold(cdr(x));
+                if (foldable(x)) {
+                    rplaca(p, evaluate(x));
+                }
+                break;
+        }
+    }
+}
+
+// native - call the native of g on the values pushed from base
+Cons *native(Symbol *g, int base) {
+    const Builtin *b = g->native;
+
+    if (0 <= b->arity) {
+        while (cx->sp - base < b->arity) {
+            push(nil);
+        }
+        cx->sp = base + b->arity;
+    }
+
+    bool prof = cx->profiling;
+    if (prof) {
+        profile_enter(profile(b, b->name));
+    }
+    Cons *p = b->fn(&cx->stack[base], cx->sp - base);
+    if (prof) {
+        profile_leave();
+    }
+
+    cx->sp = base;
+    return p;
+}
+
+Cons *run(Symbol *fn, int base, Frame *up);
+void profile_start();
+void profile_stop();
+Cons *evalform(int op, Cons *x, Frame *env);
+
+// compute - call the function s on the values pushed from base, past its cache
+Cons *compute(Symbol *s, int base, Frame *env) {
+    if (s->type == FNATIVE) {
+        return native(s, base);
+    }
+    if (s->code != nil) {
+        return run(s, base, env);
+    }
+
+    Cons *p = s->value; // p is statement list
+    bool prof = cx->profiling;
+    if (prof) {
+        profile_call(s);
+    }
+    Frame f;
+    Cons *q = eval(car(cdr(p)), bind(&f, car(p), base, env));
+    if (prof) {
+        profile_leave();
+    }
+    cx->sp = base;
+    return q;
+}
+
+// apply - call the function s on the values pushed from base
+Cons *apply(Symbol *s, int base, Frame *env) {
+    return (s->memo != nil) ? recall(s, base, env) : compute(s, base, env);
+}
+
+// funcall - call the function g on args, which are evaluated unless g is a native that quotes
+// them; FUNCALL and APPLY come here with the function they evaluate to
+Cons *funcall(Symbol *g, Cons *args, Frame *env) {
+    int base = cx->sp;
+
+    if (g->type == FNATIVE && g->native->quoted) {
+        for (Cons *p = args; p != nil; p = cdr(p)) {
+            push(car(p));
+        }
+        return native(g, base);
+    }
+
+    evalargs(args, env);
+    return apply(g, base, env);
+}
+
+Cons *eval(Cons *x, Frame *env) {
+    if (x == nil) {
+        return nil;
+    }
+
+    deep();
+
+    int t = _type(x);
+
+    if (t == SYMBOL) {
+        return *lookup(env, x);
+    }
+    if (t == LOCAL) {
+        return *slot(env, x);
+    }
+    if (t == NUMBER || vectorp(x)) {
+        return x;
+    }
+
+    int op = _op(car(x));
+
+    if (cx->profiling && builtinp(car(x)) && op != FNATIVE) {
+        profile_call(form(op));
+        Cons *p = evalform(op, x, env);
+        profile_leave();
+        return p;
+    }
+
+    return evalform(op, x, env);
+}
+
+Cons *evalform(int op, Cons *x, Frame *env) {
+    switch (op) {
+        case T:
+            return cx->TRUE;
+
+        case NIL:
+            return nil;
+
+        case QUOTE:
+            return car(cdr(x));
+
+        case FLIST:
+            return _list(x);
+
+        case COND:
+            return evalcond(cdr(x), env);
+
+        case FSETQ: {
+            Cons *p = eval(cdr(cdr(x)), env);
+            *assign(env, car(cdr(x))) = p;
+            return p;
+        }
+
+        case DEFUN: {
+            if (builtinp(car(cdr(x)))) {
+                bail("builtin");
+            }
+            Symbol *p = _sym(car(cdr(x)));
+            Cons *def = frozen(cdr(cdr(x))) ? copy(cdr(cdr(x))) : cdr(cdr(x));
+            thaw(def);
+            p->type = FUSER;
+            p->value = def;
+            resolve(cdr(def), cons(car(def), nil));
+            fold(cdr(def));
+            release(p->code);
+            if (p->memo != nil) {
+                flush(p->memo);
+            }
+            p->code = compile_body(car(cdr(p->value)));
+            if (p->inlined) {
+                p->inlined = false;
+                recompile();
+            }
+            return nil;
+        }
+
+        case FUSER:
+        case FNATIVE:
+            return funcall(_sym(car(x)), cdr(x), env);
+
+        case FAPPLY:
+        case FUNCALL: {
+            Cons *p = eval(car(cdr(x)), env); // func name
+            if (symbolp(p) && isfunc(_sym(p)->type)) {
+                return funcall(_sym(p), cdr(cdr(x)), env);
+            }
+            return nil;
+        }
+
+        case FEVAL: {
+            Cons *p = eval(cdr(x), env);
+            if (symbolp(p)) {
+                return *lookup(env, p);
+            }
+            return eval(p, env);
+        }
+
+        case FPROFILE: {
+            if (cx->profiling) {
+                return eval(car(cdr(x)), env);
+            }
+            profile_start();
+            Cons *p = eval(car(cdr(x)), env);
+            profile_stop();
+            return p;
+        }
+
+        case FAND: return _and(x, env);
+        case FOR: return _or(x, env);
+
+        case PROG:
+            return evalprog(x, env);
+
+        case GO:
+            cx->label = car(cdr(x));
+            return nil;
+
+        case RETRN:
+            cx->progon = false;
+            return eval(cdr(x), env);
+
+        case LIST: {
+            if (cdr(x) == nil) {
+                return eval(car(x), env);
+            }
+
+            Cons *p = nil; // the values of a chain of forms
+            Cons *last = nil;
+
+            for ( ; _op(car(x)) == LIST && cdr(x) != nil; x = cdr(x)) {
+                Cons *r = cons(eval(car(x), env), nil);
+                if (last == nil) {
+                    p = r;
+                } else {
+                    rplacd(last, r);
+                }
+                last = r;
+            }
+            rplacd(last, eval(x, env));
+
+            return p;
+        }
+
+        case VAR:
+            return *lookup(env, car(x));
+
+        case LOCAL:
+            return *slot(env, car(x));
+
+        case NUMBER:
+            return car(x);
+    }
+
+    return nil;
+}
+
+int count(int op) {
+    cx->profiler->opcalls[op]++;
+    return op;
+}
+
+// the compiler emits into scratch buffers, a body that does not fit or uses GO and RETURN
+// outside their PROG is left to eval
+const int LABELS = 32;
+const int NOWHERE = 0xffff; // ends the chains of jumps still to be patched
+
+struct Prog {
+    Prog *up;
+    int nvars;
+    int exit;           // chain of RETURNs
+    int nlabels, ngos;
+    Cons *labels[LABELS];
+    int at[LABELS];
+    Cons *gos[LABELS];  // GOs still to be patched
+    int from[LABELS];
+};
+
+void emit(int b) {
+    if (cx->nops < OPS) {
+        cx->ops[cx->nops++] = b;
+    } else {
+        cx->compiled = false;
+    }
+}
+
+void emit2(int w) {
+    emit(w & 0xff);
+    emit(w >> 8);
+}
+
+void patch(int at, int to) {
+    if (at + 1 < cx->nops) {
+        cx->ops[at] = to & 0xff;
+        cx->ops[at + 1] = to >> 8;
+    }
+}
+
+int constant(Cons *p) {
+    for (int i = 0; i < cx->nconsts; i++) {
+        if (cx->consts[i] == p) {
+            return i;
+        }
+    }
+
+    if (cx->nconsts == CONSTS) {
+        cx->compiled = false;
+        return 0;
+    }
+    cx->consts[cx->nconsts] = p;
+    return cx->nconsts++;
+}
+
+// jump - emit a jump linked into chain, returns the new head of the chain
+int jump(int op, int chain) {
+    emit(op);
+    int at = cx->nops;
+    emit2(chain);
+    return at;
+}
+
+// land - point the jumps of chain here
+void land(int chain) {
+    while (cx->compiled && chain != NOWHERE) {
+        int next = cx->ops[chain] | cx->ops[chain + 1] << 8;
+        patch(chain, cx->nops);
+        chain = next;
+    }
+}
+
+void compile_form(Cons *x, bool tail = false);
+
+// compile - tail is set where the value of x is the value of the function
+void compile(Cons *x, bool tail = false) {
+    switch (_type(x)) {
+        case NIL:
+            emit(OP_NIL);
+            break;
+
+        case NUMBER:
+            if (fixnump(x) && -128 <= _number(x) && _number(x) < 128) {
+                emit(OP_INT);
+                emit(_number(x) & 0xff);
+            } else {
+                emit(OP_CONST);
+                emit(constant(x));
+            }
+            break;
+
+        case SYMBOL:
+            emit(OP_GLOAD);
+            emit(constant(x));
+            break;
+
+        case LOCAL:
+            if (cx->args != nil) { // a parameter of the function being inlined
+                Cons *args = cx->args;
+                Cons *a = args;
+                for (int i = _local(x); 0 < i; i--) {
+                    a = cdr(a);
+                }
+                cx->args = nil;
+                compile(car(a), tail);
+                cx->args = args;
+                break;
+            }
+            emit(OP_LOAD);
+            emit2(_local(x));
+            break;
+
+        case LIST:
+            if (vectorp(x)) {
+                emit(OP_CONST);
+                emit(constant(x));
+                break;
+            }
+            compile_form(x, tail);
+            break;
+    }
+}
+
+int compile_args(Cons *args) {
+    int n = 0;
+
+    for (Cons *p = args; p != nil; p = cdr(p), n++) {
+        compile(car(p));
+    }
+    if (255 < n) {
+        cx->compiled = false;
+    }
+
+    return n;
+}
+
+void compile_call(Cons *x, bool tail) {
+    int n = compile_args(cdr(x));
+
+    emit(tail ? OP_TAILCALL : OP_CALL);
+    emit(constant(car(x)));
+    emit(n);
+}
+
+// a call of a small function whose body has no effects, on arguments that are constants or
+// locals, compiles to the body with the parameters compiled as the arguments; the callee is
+// marked inlined, so that defining it again compiles its callers again
+const int INLINE = 16; // cells of a body that is inlined
+
+// simple - the size of x if it only calls pure natives and refers to nothing but constants,
+// quoted data and the parameters, or more than budget
+int simple(Cons *x, int budget) {
+    if (constantp(x) || _type(x) == LOCAL || vectorp(x)) {
+        return 1;
+    }
+    if (!pairp(x)) {
+        return budget + 1;
+    }
+
+    int n = 1;
+    switch (_op(car(x))) {
+        case QUOTE:
+            return 1;
+
+        case COND:
+            for (Cons *p = cdr(x); p != nil && n <= budget; p = cdr(p)) {
+                for (Cons *q = car(p); q != nil && n <= budget; q = cdr(q)) {
+                    n += simple(car(q), budget - n);
+                }
+            }
+            return n;
+
+        case FNATIVE:
+            if (!_sym(car(x))->native->pure) {
+                return budget + 1;
+            }
+            // fall through
+        case FAND:
+        case FOR:
+            for (Cons *p = cdr(x); p != nil && n <= budget; p = cdr(p)) {
+                n += simple(car(p), budget - n);
+            }
+            return n;
+
+        default:
+            return budget + 1;
+    }
+}
+
+bool inlinable(Cons *x) {
+    Symbol *s = _sym(car(x));
+    if (s->memo != nil || cx->args != nil) {
+        return false;
+    }
+
+    Cons *a = cdr(x);
+    for (Cons *p = car(s->value); p != nil; p = cdr(p), a = cdr(a)) {
+        if (a == nil || !(constantp(car(a)) || _type(car(a)) == LOCAL)) {
+            return false;
+        }
+    }
+    return a == nil && simple(car(cdr(s->value)), INLINE) <= INLINE;
+}
+
+void compile_inline(Cons *x, bool tail) {
+    Symbol *s = _sym(car(x));
+    s->inlined = true;
+    cx->args = cdr(x);
+    compile(car(cdr(s->value)), tail);
+    cx->args = nil;
+}
+
+// compile_apply - FUNCALL and APPLY of a function are calls through the stack, the name is
+// checked when it runs and a native that quotes its arguments gets the forms
+void compile_apply(Cons *x, bool tail) {
+    compile(car(cdr(x)));
+    emit(OP_APPLY);
+    emit(constant(cdr(cdr(x))));
+    int end = cx->nops;
+    emit2(NOWHERE);
+
+    int n = compile_args(cdr(cdr(x)));
+    emit(tail ? OP_TAILCALLV : OP_CALLV);
+    emit(n);
+    land(end);
+}
+
+void compile_cond(Cons *clauses, bool tail) {
+    int end = NOWHERE;
+
+    for (Cons *p = clauses; p != nil; p = cdr(p)) {
+        compile(car(car(p)));
+        int next = jump(OP_JNIL, NOWHERE);
+        compile(car(cdr(car(p))), tail);
+        end = jump(OP_JUMP, end);
+        land(next);
+    }
+
+    emit(OP_NIL);
+    land(end);
+}
+
+// compile_logic - AND stops at the first nil, OR at the first non-nil
+void compile_logic(Cons *args, bool isand) {
+    int out = NOWHERE;
+
+    for (Cons *p = args; p != nil; p = cdr(p)) {
+        compile(car(p));
+        out = jump(isand ? OP_JNIL : OP_JNNIL, out);
+    }
+
+    emit(isand ? OP_T : OP_NIL);
+    int end = jump(OP_JUMP, NOWHERE);
+    land(out);
+    emit(isand ? OP_NIL : OP_T);
+    land(end);
+}
+
+// compile_prog - statements leave nothing on the stack but the last one, which is the value
+void compile_prog(Cons *x) {
+    Prog g;
+    g.up = cx->prog;
+    g.nvars = 0;
+    g.exit = NOWHERE;
+    g.nlabels = 0;
+    g.ngos = 0;
+
+    for (Cons *p = car(cdr(x)); p != nil; p = cdr(p)) {
+        g.nvars++;
+    }
+    emit(OP_ENTER);
+    emit(constant(car(cdr(x))));
+    cx->prog = &g;
+
+    bool value = false;
+
+    for (Cons *p = cdr(cdr(x)); p != nil; p = cdr(p)) {
+        if (value) {
+            emit(OP_POP);
+        }
+
+        if (symbolp(car(p))) {
+            if (g.nlabels == LABELS) {
+                cx->compiled = false;
+                break;
+            }
+            g.labels[g.nlabels] = car(p);
+            g.at[g.nlabels++] = cx->nops;
+            value = false;
+        } else {
+            compile(car(p));
+            value = true;
+        }
+    }
+
+    if (!value) {
+        emit(OP_NIL);
+    }
+    land(g.exit);
+    emit(OP_LEAVE);
+
+    for (int i = 0; i < g.ngos; i++) {
+        int j = 0;
+        while (j < g.nlabels && g.labels[j] != g.gos[i]) {
+            j++;
+        }
+        if (j == g.nlabels) {
+            cx->compiled = false;
+        } else {
+            patch(g.from[i], g.at[j]);
+        }
+    }
+
+    cx->prog = g.up;
+}
+
+void compile_go(Cons *x) {
+    if (cx->prog == nil || cx->prog->ngos == LABELS) {
+        cx->compiled = false;
+        return;
+    }
+
+    emit(OP_GO);
+    emit(cx->prog->nvars);
+    cx->prog->gos[cx->prog->ngos] = car(cdr(x));
+    cx->prog->from[cx->prog->ngos++] = cx->nops;
+    emit2(0);
+}
+
+void compile_return(Cons *x) {
+    if (cx->prog == nil) {
+        cx->compiled = false;
+        return;
+    }
+
+    compile_form(cdr(x));
+    emit(OP_RETURN);
+    emit(cx->prog->nvars);
+    int at = cx->nops;
+    emit2(cx->prog->exit);
+    cx->prog->exit = at;
+}
+
+// compile_native - the arguments made up to the arity of b, then its opcode; for a variadic b
+// the opcode follows each argument after the first
+void compile_native(Cons *x, const Builtin *b) {
+    int n = 0;
+
+    if (b->arity < 0) {
+        compile(car(cdr(x)));
+        for (Cons *p = cdr(cdr(x)); p != nil; p = cdr(p)) {
+            compile(car(p));
+            emit(b->op);
+        }
+        return;
+    }
+
+    for (Cons *p = cdr(x); p != nil; p = cdr(p), n++) {
+        compile(car(p));
+        if (b->arity <= n) {
+            emit(OP_POP);
+        }
+    }
+    for ( ; n < b->arity; n++) {
+        emit(OP_NIL);
+    }
+
+    emit(b->op);
+}
+
+// compile_form - follows eval, where eval takes the rest of x as a form so does the compiler
+void compile_form(Cons *x, bool tail) {
+    Cons *h = car(x);
+
+    switch (_op(h)) {
+        case T: emit(OP_T); break;
+        case NIL: emit(OP_NIL); break;
+
+        case QUOTE:
+            emit(OP_CONST);
+            emit(constant(car(cdr(x))));
+            break;
+
+        case FAND: compile_logic(cdr(x), true); break;
+        case FOR: compile_logic(cdr(x), false); break;
+
+        case COND: compile_cond(cdr(x), tail); break;
+        case PROG: compile_prog(x); break;
+        case GO: compile_go(x); break;
+        case RETRN: compile_return(x); break;
+
+        case FSETQ: {
+            Cons *q = car(cdr(x));
+            compile_form(cdr(cdr(x)));
+            if (_type(q) == LOCAL) {
+                emit(OP_STORE);
+                emit2(_local(q));
+            } else if (symbolp(q)) {
+                emit(OP_GSTORE);
+                emit(constant(q));
+            } else {
+                cx->compiled = false;
+            }
+            break;
+        }
+
+        case FNATIVE: {
+            const Builtin *b = _sym(h)->native;
+            if (0 <= b->op && (0 <= b->arity || pairp(cdr(cdr(x))))) {
+                compile_native(x, b);
+            } else if (!b->quoted) {
+                compile_call(x, tail);
+            } else {
+                emit(OP_EVAL);
+                emit(constant(x));
+            }
+            break;
+        }
+
+        case FUSER:
+            if (inlinable(x)) {
+                compile_inline(x, tail);
+                break;
+            }
+            // fall through
+        case VAR: // may be defined as a function by the time it runs
+            compile_call(x, tail);
+            break;
+
+        case FUNCALL:
+        case FAPPLY:
+            compile_apply(x, tail);
+            break;
+
+        case LIST:
+            if (cdr(x) == nil) {
+                compile(h, tail);
+                break;
+            }
+            compile(h);
+            if (cdr(x) != nil) {
+                compile_form(cdr(x));
+                emit(OP_CONS);
+            }
+            break;
+
+        case LOCAL:
+        case NUMBER:
+            compile(h);
+            break;
+
+        default:
+            emit(OP_EVAL);
+            emit(constant(x));
+            break;
+    }
+}
+
+// compile_body - bytecode for the body of a DEFUN, or nil to leave it to eval
+Code *compile_body(Cons *body) {
+    cx->nops = 0;
+    cx->nconsts = 0;
+    cx->compiled = true;
+    cx->prog = nil;
+    cx->args = nil;
+
+    compile(body, true);
+    emit(OP_RET);
+
+    if (!cx->compiled) {
+        return nil;
+    }
+
+    Code *c = new (std::nothrow) Code;
+    if (c == nil) {
+        return nil;
+    }
+    c->ops = new (std::nothrow) uint8_t[cx->nops];
+    c->consts = new (std::nothrow) Cons *[cx->nconsts + 1];
+    c->nconsts = cx->nconsts;
+    c->next = nil;
+    if (c->ops == nil || c->consts == nil) {
+        delete[] c->ops;
+        delete[] c->consts;
+        delete c;
+        return nil;
+    }
+
+    memcpy(c->ops, cx->ops, cx->nops);
+    memcpy(c->consts, cx->consts, cx->nconsts * sizeof(Cons *));
+
+    return c;
+}
+
+// recompile - compile every function again, when one that was inlined has changed
+void recompile() {
+    for (unsigned i = 0; i < cx->symcap; i++) {
+        Symbol *s = cx->symtab[i];
+        if (s != nil && s->type == FUSER) {
+            release(s->code);
+            s->code = compile_body(car(cdr(s->value)));
+        }
+    }
+}
+
+bool running(Code *c) {
+    for (int i = 0; i < cx->csp; i++) {
+        if (cx->calls[i].code == c) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void discard(Code *c) {
+    delete[] c->ops;
+    delete[] c->consts;
+    delete c;
+}
+
+// retire - free the released code that has stopped running, whether its calls returned,
+// were replaced by tail calls or were unwound by an error
+void retire() {
+    for (Code **p = &cx->released; *p != nil; ) {
+        Code *c = *p;
+        if (running(c)) {
+            p = &c->next;
+        } else {
+            *p = c->next;
+            discard(c);
+        }
+    }
+}
+
+// release - free the code of a redefined function, or once it stops running
+void release(Code *c) {
+    retire();
+    if (c == nil) {
+        return;
+    }
+
+    if (running(c)) {
+        c->next = cx->released;
+        cx->released = c;
+        return;
+    }
+    discard(c);
+}
+
+// call - push the record for a frame over the values pushed from base
+Frame *call(Code *code, const uint8_t *ret, Cons *pars, int base, Frame *up) {
+    if (cx->csp == CALLS) {
+        bail("stack overflow");
+    }
+
+    Call *c = &cx->calls[cx->csp++];
+    c->code = code;
+    c->ret = ret;
+    c->profiled = false;
+
+    return bind(&c->frame, pars, base, up);
+}
+
+bool hides(Cons *pars, Cons *name) {
+    for ( ; pars != nil; pars = cdr(pars)) {
+        if (car(pars) == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// rebind - make f, the frame of the caller of a tail call, the frame of the callee for pars on
+// the values pushed from b; the names of f that pars does not shadow stay after them, so that
+// lookup finds what it found through both frames, and functions that tail call each other run
+// in one frame that stops growing once it holds the names of them all
+void rebind(Frame *f, Cons *pars, int b) {
+    int base = f->slots - cx->stack;
+    if (pars == f->pars) { // a call to itself only takes the arguments
+        int n = cx->sp - b;
+        memmove(f->slots, &cx->stack[b], n * sizeof(Cons *));
+        cx->sp = base + n;
+        bind(f, pars, base, f->up);
+        return;
+    }
+
+    int n = 0;
+    for (Cons *p = pars; p != nil; p = cdr(p)) {
+        n++;
+    }
+    while (cx->sp - b < n) {
+        push(nil);
+    }
+    cx->sp = b + n; // arguments past the parameters are cut
+
+    Cons *p = pars;
+    Cons *q = f->pars;
+    while (p != nil && q != nil && car(p) == car(q)) {
+        p = cdr(p);
+        q = cdr(q);
+    }
+
+    Cons *names = f->pars; // pars begins them, the rest keep their slots
+    int k = 0;
+    if (p == nil) {
+        for ( ; q != nil; q = cdr(q)) {
+            k++;
+        }
+    } else {
+        int i = 0;
+        for (q = f->pars; q != nil; q = cdr(q), i++) {
+            if (!hides(pars, car(q))) {
+                push(f->slots[i]);
+                k++;
+            }
+        }
+
+        names = pars;
+        if (k != 0) {
+            push(nil); // the names, rooted while they are consed
+            Cons *last = nil;
+            for (int j = 0; j < 2; j++) {
+                for (q = (j == 0) ? pars : f->pars; q != nil; q = cdr(q)) {
+                    if (j == 0 || !hides(pars, car(q))) {
+                        Cons *c = cons(car(q), nil);
+                        if (last == nil) {
+                            cx->stack[cx->sp - 1] = c;
+                        } else {
+                            rplacd(last, c);
+                        }
+                        last = c;
+                    }
+                }
+            }
+            names = cx->stack[--cx->sp];
+        }
+    }
+
+    memmove(f->slots, &cx->stack[b], ((p == nil) ? n : n + k) * sizeof(Cons *));
+    cx->sp = base + n + k;
+    bind(f, names, base, f->up);
+}
+
+#if __GNUC__
+#define CASE(op) L_##op
+#define NEXT goto *table[*pc++]
+#else
+#define CASE(op) case op
+#define NEXT continue
+#endif
+
+#define WORD(p) ((p)[0] | (p)[1] << 8)
+#define TOP cx->stack[cx->sp - 1]
+
+#if __GNUC__
+// counting - the dispatch table of the profiler, every opcode goes to the counting stub at l
+void *const *counting(void *l) {
+    static void *table[OPCODES];
+    for (int i = 0; i < OPCODES; i++) {
+        table[i] = l;
+    }
+    return table;
+}
+#endif
+
+// run - execute the compiled body of fn on the arguments pushed from base, calls between
+// compiled functions stay in this loop and only eval recurses
+Cons *run(Symbol *fn, int base, Frame *up) {
+    int entry = cx->csp;
+    Code *code = fn->code;
+    Frame *f = call(code, nil, car(fn->value), base, up);
+    const uint8_t *pc = code->ops;
+    bool prof = cx->profiling; // count the opcodes
+    Cons *x;
+    Cons *s;
+    int b;
+
+    if (prof) {
+        cx->calls[cx->csp - 1].profiled = true;
+        profile_call(fn);
+    }
+
+#if __GNUC__
+    static void *const dispatch[] = {
+        &&L_OP_NIL, &&L_OP_T, &&L_OP_INT, &&L_OP_CONST, &&L_OP_LOAD, &&L_OP_STORE,
+        &&L_OP_GLOAD, &&L_OP_GSTORE, &&L_OP_POP, &&L_OP_JUMP, &&L_OP_JNIL, &&L_OP_JNNIL,
+        &&L_OP_CALL, &&L_OP_TAILCALL, &&L_OP_APPLY, &&L_OP_CALLV, &&L_OP_TAILCALLV, &&L_OP_RET, &&L_OP_EVAL, &&L_OP_ENTER, &&L_OP_LEAVE, &&L_OP_GO,
+        &&L_OP_RETURN, &&L_OP_ADD, &&L_OP_SUB, &&L_OP_MUL, &&L_OP_DIV, &&L_OP_INC,
+        &&L_OP_DEC, &&L_OP_LT, &&L_OP_GT, &&L_OP_ZEROP, &&L_OP_NUMBERP, &&L_OP_NULL,
+        &&L_OP_EQ, &&L_OP_ATOM, &&L_OP_NOT, &&L_OP_CAR, &&L_OP_CDR, &&L_OP_CONS
+    };
+    static void *const *const counted = counting(&&L_COUNT); // filled once, even across threads
+
+    void *const *table = prof ? counted : dispatch;
+
+    NEXT;
+    {
+        L_COUNT:
+            cx->profiler->opcalls[pc[-1]]++;
+            goto *dispatch[pc[-1]];
+#else
+    while (true) switch (prof ? count(*pc++) : *pc++) {
+#endif
+        CASE(OP_NIL): push(nil); NEXT;
+        CASE(OP_T): push(cx->TRUE); NEXT;
+        CASE(OP_INT): push(number((int8_t)*pc++)); NEXT;
+        CASE(OP_CONST): push(code->consts[*pc++]); NEXT;
+
+        CASE(OP_LOAD): {
+            Frame *g = f;
+            for (int d = pc[1]; d > 0; d--) {
+                g = g->up;
+            }
+            push(g->slots[pc[0]]);
+            pc += 2;
+            NEXT;
+        }
+
+        CASE(OP_STORE): {
+            Frame *g = f;
+            for (int d = pc[1]; d > 0; d--) {
+                g = g->up;
+            }
+            g->slots[pc[0]] = TOP;
+            pc += 2;
+            NEXT;
+        }
+
+        CASE(OP_GLOAD): push(*lookup(f, code->consts[*pc++])); NEXT;
+        CASE(OP_GSTORE): *assign(f, code->consts[*pc++]) = TOP; NEXT;
+        CASE(OP_POP): cx->sp--; NEXT;
+
+        CASE(OP_JUMP): pc = code->ops + WORD(pc); NEXT;
+        CASE(OP_JNIL): pc = (cx->stack[--cx->sp] == nil) ? code->ops + WORD(pc) : pc + 2; NEXT;
+        CASE(OP_JNNIL): pc = (cx->stack[--cx->sp] != nil) ? code->ops + WORD(pc) : pc + 2; NEXT;
+
+        CASE(OP_CALL):
+            s = code->consts[pc[0]];
+            b = cx->sp - pc[1];
+            pc += 2;
+            goto invoke;
+
+        CASE(OP_TAILCALL):
+            s = code->consts[pc[0]];
+            b = cx->sp - pc[1];
+            pc += 2;
+            goto tail;
+
+        CASE(OP_APPLY):
+            x = TOP;
+            if (!symbolp(x) || !isfunc(_sym(x)->type) ||
+                (_sym(x)->type == FNATIVE && _sym(x)->native->quoted)) {
+                cx->sp--;
+                x = (symbolp(x) && isfunc(_sym(x)->type)) ? funcall(_sym(x), code->consts[pc[0]], f) : nil;
+                push(x);
+                pc = code->ops + WORD(pc + 1);
+                NEXT;
+            }
+            pc += 3;
+            NEXT;
+
+        CASE(OP_CALLV):
+        CASE(OP_TAILCALLV):
+            b = cx->sp - pc[0];
+            s = cx->stack[b - 1]; // the arguments move down over the function
+            memmove(&cx->stack[b - 1], &cx->stack[b], (cx->sp - b) * sizeof(Cons *));
+            cx->sp--;
+            b--;
+            pc++;
+            if (pc[-2] == OP_CALLV) {
+                goto invoke;
+            }
+
+        tail: { // the caller's frame becomes the callee's, see rebind
+            Symbol *g = _sym(s);
+
+            if (g->type == FUSER && g->code != nil && g->memo == nil) {
+                rebind(f, car(g->value), b);
+                code = cx->calls[cx->csp - 1].code = g->code;
+                if (cx->calls[cx->csp - 1].profiled) {
+                    profile_leave();
+                    profile_call(g);
+                }
+                pc = code->ops;
+                NEXT;
+            }
+        }
+
+        invoke: {
+            Symbol *g = _sym(s);
+
+            if (g->type == FNATIVE) {
+                x = native(g, b);
+                push(x);
+            } else if (g->type != FUSER) { // still a variable, the form is its value
+                cx->sp = b;
+                push(*lookup(f, s));
+            } else if (g->memo != nil) {
+                x = recall(g, b, f);
+                push(x);
+            } else if (g->code == nil) {
+                bool p = cx->profiling;
+                if (p) {
+                    profile_call(g);
+                }
+                Frame h;
+                x = eval(car(cdr(g->value)), bind(&h, car(g->value), b, f));
+                if (p) {
+                    profile_leave();
+                }
+                cx->sp = b;
+                push(x);
+            } else {
+                f = call(g->code, pc, car(g->value), b, f);
+                code = g->code;
+                pc = code->ops;
+                if (cx->profiling) {
+                    cx->calls[cx->csp - 1].profiled = true;
+                    profile_call(g);
+                }
+            }
+            NEXT;
+        }
+
+        CASE(OP_RET): {
+            x = TOP;
+            Call *c = &cx->calls[--cx->csp];
+            cx->sp = c->frame.slots - cx->stack;
+            if (c->profiled) {
+                profile_leave();
+            }
+            if (cx->csp == entry) {
+                return x;
+            }
+            pc = c->ret;
+            code = cx->calls[cx->csp - 1].code;
+            f = &cx->calls[cx->csp - 1].frame;
+            push(x);
+            NEXT;
+        }
+
+        CASE(OP_EVAL):
+            x = eval(code->consts[*pc++], f);
+            push(x);
+            NEXT;
+
+        CASE(OP_ENTER): f = call(code, nil, code->consts[*pc++], cx->sp, f); NEXT;
+
+        CASE(OP_LEAVE): {
+            x = TOP;
+            cx->sp = cx->calls[--cx->csp].frame.slots - cx->stack;
+            f = &cx->calls[cx->csp - 1].frame;
+            push(x);
+            NEXT;
+        }
+
+        CASE(OP_GO):
+            cx->sp = (f->slots - cx->stack) + pc[0];
+            pc = code->ops + WORD(pc + 1);
+            NEXT;
+
+        CASE(OP_RETURN):
+            x = TOP;
+            cx->sp = (f->slots - cx->stack) + pc[0];
+            push(x);
+            pc = code->ops + WORD(pc + 1);
+            NEXT;
+
+        CASE(OP_ADD): cx->sp--; TOP = add(TOP, cx->stack[cx->sp]); NEXT;
+        CASE(OP_SUB): cx->sp--; TOP = sub(TOP, cx->stack[cx->sp]); NEXT;
+        CASE(OP_MUL): cx->sp--; TOP = mul(TOP, cx->stack[cx->sp]); NEXT;
+        CASE(OP_DIV): cx->sp--; TOP = quot(TOP, cx->stack[cx->sp]); NEXT;
+        CASE(OP_INC): TOP = add(TOP, number(1)); NEXT;
+        CASE(OP_DEC): TOP = sub(TOP, number(1)); NEXT;
+        CASE(OP_LT): cx->sp--; TOP = less(TOP, cx->stack[cx->sp]) ? cx->TRUE : nil; NEXT;
+        CASE(OP_GT): cx->sp--; TOP = less(cx->stack[cx->sp], TOP) ? cx->TRUE : nil; NEXT;
+
+        CASE(OP_ZEROP): TOP = zerop(TOP) ? cx->TRUE : nil; NEXT;
+        CASE(OP_NUMBERP): TOP = (_type(TOP) == NUMBER) ? cx->TRUE : nil; NEXT;
+        CASE(OP_NULL): TOP = eq(TOP, nil); NEXT;
+        CASE(OP_EQ): cx->sp--; TOP = eq(TOP, cx->stack[cx->sp]); NEXT;
+        CASE(OP_ATOM): TOP = atom(TOP); NEXT;
+        CASE(OP_NOT): TOP = (TOP == nil) ? cx->TRUE : nil; NEXT;
+        CASE(OP_CAR): TOP = car(TOP); NEXT;
+        CASE(OP_CDR): TOP = cdr(TOP); NEXT;
+
+        CASE(OP_CONS):
+            x = cons(cx->stack[cx->sp - 2], TOP); // both still on the stack for the collector
+            cx->stack[--cx->sp - 1] = x;
+            NEXT;
+    }
+
+    return nil;
+}
+
+#undef CASE
+#undef NEXT
+#undef WORD
+#undef TOP
+
+// builtin - the record of the native or form an opcode was compiled from, or nil
+Profile *builtin(int op) {
+    if (op == OP_APPLY) {
+        return profile(form(FUNCALL), form(FUNCALL)->name);
+    }
+    for (int i = 0; i < NATIVES; i++) {
+        if (natives[i].op == op) {
+            return profile(&natives[i], natives[i].name);
+        }
+    }
+
+    return nil;
+}
+
+void profile_start() {
+    if (cx->profiler == nil) {
+        cx->profiler = new (std::nothrow) Profiler;
+        if (cx->profiler == nil) {
+            bail("out of memory");
+        }
+    }
+
+    Profiler *r = cx->profiler;
+    memset(r, 0, sizeof(*r));
+    cx->profiling = true;
+    r->allocs = cx->allocs;
+    r->start = _cycles();
+}
+
+// _putfield - s in a column of width w, right-aligned unless w is negative
+void _putfield(const char *s, int w) {
+    int n = strlen(s);
+
+    for ( ; n < w; n++) {
+        _putc(' ');
+    }
+    _puts(s);
+    for ( ; n < -w; n++) {
+        _putc(' ');
+    }
+}
+
+// profile_stop - report the records by exclusive time; builtins compiled to opcodes are
+// counted, their time is part of the function they were compiled into
+void profile_stop() {
+    Profiler *r = cx->profiler;
+    uint64_t t = _cycles() - r->start;
+    cx->profiling = false;
+
+    for (int op = 0; op < OPCODES; op++) {
+        Profile *p = (r->opcalls[op] == 0) ? nil : builtin(op);
+        if (p != nil) {
+            p->calls += r->opcalls[op];
+            p->cells += (op == OP_CONS) ? r->opcalls[op] : 0;
+        }
+    }
+
+    Profile *order[PROFILES];
+    int n = 0;
+
+    for (int i = 0; i < PROFILES; i++) {
+        if (r->profiles[i].key != nil) {
+            int j = n++;
+            for ( ; 0 < j && order[j - 1]->excl < r->profiles[i].excl; j--) {
+                order[j] = order[j - 1];
+            }
+            order[j] = &r->profiles[i];
+        }
+    }
+
+    _puts("profile: ");
+    _putcol(t, 0);
+    _puts(" " CYCLES ", ");
+    _putcol(cx->allocs - r->allocs, 0);
+    _puts(" cells\n");
+    _putfield("", -16);
+    _putfield("calls", 10);
+    _putfield("incl " CYCLES, 15);
+    _putfield("excl " CYCLES, 15);
+    _putfield("cells", 10);
+    _putc('\n');
+
+    for (int i = 0; i < n; i++) {
+        _putfield(order[i]->name, -16);
+        _putcol(order[i]->calls, 10);
+        _putcol(order[i]->incl, 15);
+        _putcol(order[i]->excl, 15);
+        _putcol(order[i]->cells, 10);
+        _putc('\n');
+    }
+}
+
+// evalall - read and evaluate forms to the end of the input, the value of the last one is kept
+// at stack[at] where the collector sees it while the rest is read
+Cons *evalall(int at) {
+    Cons *p = nil;
+
+    for (token_t t; (t = read_token()) != EOT; ) {
+        if (t == LPAREN) {
+            _getc();
+            p = ::eval(read(), nil);
+        } else if (t == ALPHA) {
+            p = *lookup(nil, read_symbol());
+        } else if (t == STRING) {
+            p = read_string();
+        } else {
+            _getc();
+        }
+        cx->stack[at] = p;
+    }
+
+    return p;
+}
+
+void repl() {
+    Cons *p = nil;
+    bool cont = false;
+    bool oops = false;
+
+    if (setjmp(cx->toplevel) != 0) {
+        cx->sp = 0;
+        cx->csp = 0;
+        cx->profiling = false;
+        cx->progon = true;
+        cx->label = nil;
+        p = nil;
+        cont = false;
+        oops = true;
+    }
+
+    while (true) {
+        if (!cont && !oops) {
+            _puts("\033[31m" "ζ " "\033[32m" "=> " "\033[0m");
+            _flush();
+        }
+
+        switch (read_token()) {
+            case LPAREN:
+                _getc();
+                p = eval(read(), nil);
+                cont = true;
+                break;
+
+            case ALPHA:
+                p = *lookup(nil, read_symbol());
+                cont = true;
+                break;
+
+            case STRING:
+                p = read_string();
+                cont = true;
+                break;
+
+            case QUOTED:
+            case RPAREN:
+            case DIGIT:
+            case ERR:
+            case BLANK:
+                _getc();
+                _puts("\033[33m" "oops!" "\033[0m" "\n");
+                p = nil;
+                oops = true;
+                break;
+
+            case EOL:
+                _getc();
+                if (!oops) {
+                    if (p == nil) {
+                        _puts("nil");
+                    } else {
+                        print(cons(p, nil));
+                    }
+                    _putc('\n');
+                }
+                p = nil;
+                cont = false;
+                oops = false;
+                break;
+
+            case EOT:
+                _getc();
+                return;
+        }
+    }
+}
+
+// init - set up the heap and enter the builtins
+void init() {
+    static bool syntax = (init_syntax(), true); // once, for all the contexts
+    (void)syntax;
+
+    grow();
+    _cycles_init();
+
+    for (int i = 0; i < IMAGE; i++) {
+        enter((Symbol *)&image[i]);
+    }
+    cx->TRUE = image[0].value;
+    cx->TICK = intern("'");
+
+    cx->back.n = 0;
+    cx->progon = true;
+}
+
+// Use - run on a context for the extent of an API call, the frame of the outermost call is
+// the top of the C stack scanned for roots
+struct Use {
+    Context *was;
+
+    Use(Context *c, void *base) {
+#if __MBED__
+        turn->lock();
+#endif
+        was = cx;
+        cx = c;
+        if (cx->entered++ == 0) {
+            cx->stackbase = base;
+        }
+    }
+
+    ~Use() {
+        cx->entered--;
+        cx = was;
+#if __MBED__
+        turn->unlock();
+#endif
+    }
+};
+
+Cortex::Cortex(const CortexIo &io) {
+    context = new Context();
+    context->io = io;
+
+    Use use(context, __builtin_frame_address(0));
+    init();
+}
+
+Cortex::~Cortex() {
+#if __MBED__
+    turn->lock();
+#endif
+    Context *was = cx;
+    cx = context;
+
+    for (unsigned i = 0; i < cx->symcap; i++) {
+        if (cx->symtab[i] != nil && cx->symtab[i]->type == FUSER) {
+            release(cx->symtab[i]->code);
+            unmemo(cx->symtab[i]);
+        }
+    }
+    retire();
+    delete[] cx->symtab;
+    while (cx->blocks != nil) {
+        Block *b = cx->blocks;
+        cx->blocks = b->next;
+        delete[] (char *)b;
+    }
+    for (int j = 0; j < cx->npages; j++) {
+        for (int i = 0; i < PAGE; i++) {
+            if (vectorp(&cx->pages[j]->cells[i])) {
+                unvector(&cx->pages[j]->cells[i]);
+            }
+        }
+        delete cx->pages[j];
+    }
+    delete cx->profiler;
+    delete[] cx->shared;
+    delete cx;
+    cx = was;
+#if __MBED__
+    turn->unlock();
+#endif
+}
+
+void Cortex::define(const char *name, Native fn, int arity, bool quoted) {
+    Use use(context, __builtin_frame_address(0));
+
+    Cons *p = intern(name);
+    if (builtinp(p)) {
+        p = declare(_symbol(p)); // shadows the builtin in this context
+    }
+
+    Builtin *b = (Builtin *)block(sizeof(Builtin));
+    b->name = _symbol(p);
+    b->fn = fn;
+    b->arity = arity;
+    b->op = -1;
+    b->quoted = quoted;
+    b->pure = false; // the host's natives may have effects, they are never folded
+
+    _sym(p)->type = FNATIVE;
+    _sym(p)->native = b;
+}
+
+Cons *Cortex::eval(const char *src, size_t n) {
+    Use use(context, __builtin_frame_address(0));
+
+    jmp_buf toplevel;
+    memcpy(toplevel, cx->toplevel, sizeof(jmp_buf));
+    const char *was = cx->src;
+    const char *wasend = cx->srcend;
+    Pushback back = cx->back;
+    int sp = cx->sp;
+    int csp = cx->csp;
+    Cons *p = nil;
+
+    cx->src = src;
+    cx->srcend = src + n;
+    cx->back.n = 0;
+    cx->error = nil;
+
+    push(nil); // the value so far, rooted while the rest is read
+    if (setjmp(cx->toplevel) == 0) {
+        p = evalall(sp);
+    } else {
+        cx->profiling = false;
+        cx->progon = true;
+        cx->label = nil;
+        p = nil;
+    }
+
+    memcpy(cx->toplevel, toplevel, sizeof(jmp_buf));
+    cx->src = was;
+    cx->srcend = wasend;
+    cx->back = back;
+    cx->sp = sp;
+    cx->csp = csp;
+    return p;
+}
+
+Cons *Cortex::eval(const char *src) { return eval(src, strlen(src)); }
+
+void Cortex::print(Cons *p) {
+    Use use(context, __builtin_frame_address(0));
+
+    jmp_buf toplevel;
+    memcpy(toplevel, cx->toplevel, sizeof(jmp_buf));
+    if (setjmp(cx->toplevel) == 0) {
+        if (p == nil) {
+            _puts("nil");
+        } else {
+            ::print(cons(p, nil));
+        }
+    }
+    memcpy(cx->toplevel, toplevel, sizeof(jmp_buf));
+    _flush();
+}
+
+void Cortex::repl() {
+    Use use(context, __builtin_frame_address(0));
+
+    ::repl();
+}
+
+const char *Cortex::error() const { return context->error; }
+
+CortexStats Cortex::stats() {
+    CortexStats s = { context->allocs, context->gcs, context->cells, context->cellsfree, context->gcpeak };
+    context->gcpeak = 0;
+    return s;
+}
+
@@ -0,0 +1,77 @@
+#ifndef CORTEX_H
+#define CORTEX_H
+
+#include <stddef.h>
+
+#define nil NULL
+
+// values are opaque to the host, they are taken apart and made with the functions below
+struct Cons;
+struct Context;
+
+// a native function gets its n arguments in args, evaluated unless it was defined quoted
+typedef Cons *(*Native)(Cons **args, int n);
+
+// the console of a context, getc returns EOF at the end of the input; write, where it is
+// not nil, takes the output a run of bytes at a time instead of putc
+struct CortexIo {
+    int (*getc)(void *user);
+    void (*putc)(int c, void *user);
+    void (*flush)(void *user);
+    void *user;
+    void (*write)(const char *s, size_t n, void *user);
+};
+
+struct CortexStats {
+    unsigned allocs; // cells allocated so far
+    unsigned gcs;
+    int cells;       // cells in the heap
+    int cellsfree;
+    int peak;        // most cells live after a collection since the last call
+};
+
+// Cortex - an interpreter with its own heap, symbols and stacks; values returned by eval
+// stay valid until the next call that may collect
+class Cortex {
+public:
+    explicit Cortex(const CortexIo &io);
+    ~Cortex();
+
+    // define - bind name to fn in this context, fn gets arity arguments (padded with nil or
+    // cut) unless that is -1
+    void define(const char *name, Native fn, int arity = -1, bool quoted = false);
+
+    // eval - read and evaluate the forms in src, the value of the last one or nil on error
+    Cons *eval(const char *src, size_t n);
+    Cons *eval(const char *src);
+
+    void print(Cons *p);
+    void repl();
+
+    const char *error() const; // why the last eval failed, or nil
+    CortexStats stats();
+
+private:
+    Context *context;
+
+    Cortex(const Cortex &);
+    Cortex &operator=(const Cortex &);
+};
+
+Cons *car(Cons *p);
+Cons *cdr(Cons *p);
+Cons *cons(Cons *car, Cons *cdr);
+Cons *number(int n);
+Cons *intern(const char *name);
+
+bool fixnump(Cons *p);
+bool pairp(Cons *p);
+bool symbolp(Cons *p);
+
+int _number(Cons *p);
+const char *_symbol(Cons *p);
+
+// bail - abandon the evaluation, natives call it on bad arguments
+void bail(const char *why);
+
+#endif
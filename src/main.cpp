@@ -5,34 +5,150 @@
 #include <stdio.h>
 #include <string.h>
 
-#define nil NULL
+#include "cortex.h"
 
+#if COMPONENT_FLASHIAP
+#include "FlashIAPBlockDevice.h"
+#include "LittleFileSystem.h"
+
+// save-image writes to a littlefs on the flash past the program, mounted at /fs; at boot the
+// image is restored and /fs/boot.lisp is loaded
+FlashIAPBlockDevice flash;
+LittleFileSystem fs("fs");
+#endif
+
+// the interpreter talks to the serial console, or stdio on the host; the device code below
+// reports on the console too
 #if DEVICE_SERIAL
+#include "platform/CircularBuffer.h"
+
+#ifndef MBED_CONF_APP_TX_BUFFER
+#define MBED_CONF_APP_TX_BUFFER 512
+#endif
+#ifndef MBED_CONF_APP_RX_BUFFER
+#define MBED_CONF_APP_RX_BUFFER 1024
+#endif
+
+// output is queued in a ring that the transmit interrupt drains, so that printing only waits
+// on the UART when the ring is full; only the interrupt writes to the UART while it is attached
 RawSerial io(USBTX, USBRX/*, 115200*/);
+CircularBuffer<char, MBED_CONF_APP_TX_BUFFER> tx;
+volatile bool txon; // the transmit interrupt is attached
+
+void tx_irq() {
+    char c;
+    while (io.writeable() && tx.pop(c)) {
+        io.putc(c);
+    }
+    if (txon && tx.empty()) {
+        io.attach(nil, SerialBase::TxIrq);
+        txon = false;
+    }
+}
+
+// kick - start draining the ring, unless the interrupt is at it
+void kick() {
+    core_util_critical_section_enter();
+    if (!txon) {
+        tx_irq();
+        if (!tx.empty()) {
+            txon = true;
+            io.attach(tx_irq, SerialBase::TxIrq);
+        }
+    }
+    core_util_critical_section_exit();
+}
+
+void console_write(const char *s, size_t n, void *) {
+    for (size_t i = 0; i < n; i++) {
+        while (tx.full()) {
+            kick();
+        }
+        tx.push(s[i]);
+    }
+    kick();
+}
+
+// input is taken by the receive interrupt into a ring, so that what arrives while eval runs is
+// kept; the reader is handed a line once its end is in the ring, or once the input goes quiet
+// with part of a line, as when someone types
+CircularBuffer<char, MBED_CONF_APP_RX_BUFFER> rx;
+rtos::Semaphore rxed; // released at the end of a line, when the ring fills, or for a waiting byte
+volatile uint32_t ends; // ends of lines in the ring
+volatile uint32_t received; // bytes so far, to tell that the input is quiet
+volatile bool hungry; // the reader waits for any byte, the ring being empty
+bool online; // the reader is being handed a line
+
+const int QUIET = 20; // ms without input after which part of a line is handed over
+
+void rx_irq() {
+    while (io.readable()) {
+        char c = io.getc();
+        bool end = (c == '\n' || c == '\r');
+        if (!rx.full()) { // a byte that finds the ring full is lost
+            rx.push(c);
+            received++;
+            ends += end;
+        }
+        if (end || hungry || rx.full()) {
+            rxed.release();
+        }
+    }
+}
+
+int console_getc(void *) {
+    while (!online) {
+        uint32_t seen = received;
+        if (ends != 0 || rx.full()) {
+            online = true;
+        } else if (rx.empty()) { // sleep until the first byte, looking again once it would wake us
+            hungry = true;
+            if (rx.empty()) {
+                rxed.acquire();
+            }
+            hungry = false;
+        } else if (!rxed.try_acquire_for(QUIET) && received == seen) {
+            online = true;
+        }
+    }
 
-int poop = EOF;
+    char c;
+    hungry = true;
+    while (!rx.pop(c)) { // the line was handed over before its end came
+        rxed.acquire();
+    }
+    hungry = false;
 
-int _getc() {
-    if (poop != EOF) {
-        int c = poop;
-        poop = EOF;
-        return c;
+    if (c == '\n' || c == '\r') {
+        core_util_atomic_decr_u32(&ends, 1);
+        online = false;
     }
+    return (unsigned char)c;
+}
+
+void console_init() { io.attach(rx_irq, SerialBase::RxIrq); }
+
+void console_putc(int c, void *) { char b = c; console_write(&b, 1, nil); }
+void console_flush(void *) { kick(); }
 
-    return io.getc();
+// console_drain - wait for the ring to empty, before the device sleeps
+void console_drain() {
+    while (txon) {
+    }
 }
 
-void _ungetc(int c) { poop = c; }
-void _putc(int c) { io.putc(c); }
-void _flush() { }
+static void _putc(int c) { console_putc(c, nil); }
 #else
-int _getc() { return fgetc(stdin); }
-void _ungetc(int c) { ungetc(c, stdin); }
-void _putc(int c) { fputc(c, stdout); }
-void _flush() { fflush(stdout); }
+void console_init() { }
+int console_getc(void *) { return getchar(); }
+void console_putc(int c, void *) { putchar(c); }
+void console_write(const char *s, size_t n, void *) { fwrite(s, 1, n, stdout); }
+void console_flush(void *) { fflush(stdout); }
+void console_drain() { fflush(stdout); }
 #endif
 
-void _putn(int n) {
+#if __MBED__
+static void _putn(int n) {
     if (n < 0) {
         _putc('-');
         n = -n;
@@ -55,12 +171,8 @@ void _putn(int n) {
     }
 }
 
-void _puts(const char *s) {
-    while (*s != '\0') {
-        _putc(*s);
-        s++;
-    }
-}
+static void _puts(const char *s) { console_write(s, strlen(s), nil); }
+#endif
 
 #if DEVICE_SLEEP
 uint32_t ispr0, ispr1, ispr2, icsr;
@@ -76,6 +188,8 @@ uint32_t ispr0, ispr1, ispr2, icsr;
 })
 
 void _sleep() {
+    console_drain(); // the transmit interrupt would wake the device
+
     core_util_critical_section_enter();
 
 #if DEVICE_USTICKER
@@ -625,676 +739,40 @@ void zoolog() {
 }
 #endif
 
-typedef enum { EOT = -1, ERR, QUOTED, LPAREN, RPAREN, ALPHA, DIGIT, EOL } token_t;
-
-enum {
-    LIST, NUMBER, SYMBOL, VAR, QUOTE, NIL, T, COND, DEFUN, FSETQ, NULLP, FUNCALL, PROG, GO, RETRN, LABL, FREPLACA, FREPLACD, FAPPLY, FLIST,
 #if FEATURE_BLE
-    BLEUART,
-#endif
-#if DEVICE_ANALOGIN
-    ZOOLOG,
-#endif
-    FUSER, FADD1, FSUB1, FPLUS, FDIFF, FTIMES, FQUOT, LESSP, EQP, GREATERP, ZEROP, NUMBERP, FAND, FOR, FNOT, FCONS, FCAR, FCDR, FREAD, FEVAL, FPRINT, FATOM
-};
-
-int isfunc(int t) { return (FUSER <= t); }
-
-struct Cons {
-    int type;
-    union {
-        int number;
-        const char *symbol;
-    } u;
-    Cons *car;
-    Cons *cdr;
-
-    Cons(Cons *car, Cons *cdr) : type(LIST), car(car), cdr(cdr) { }
-};
-
-Cons *cons(Cons *car, Cons *cdr) { return new Cons(car, cdr); }
-
-Cons *car(Cons *p) { return (p == nil) ? nil : p->car; }
-Cons *cdr(Cons *p) { return (p == nil) ? nil : p->cdr; }
-
-int _type(Cons *p) { return p->type; }
-int _number(Cons *p) { return p->u.number; }
-const char *_symbol(Cons *p) { return (p == nil) ? nil : p->u.symbol; }
-
-void rplaca(Cons *p, Cons *q) { p->car = q; }
-void rplacd(Cons *p, Cons *q) { p->cdr = q; }
-void rplact(Cons *p, int t) { p->type = t; }
-
-Cons *number(int n) {
-    Cons *p = cons(nil, nil);
-    p->u.number = n;
-    rplact(p, NUMBER);
-
-    return p;
-}
-
-Cons *ENV;
-Cons *TRUE;
-
-Cons *declare(const char *name) {
-    Cons *p = cons(nil, nil);
-    p->u.symbol = name;
-    rplact(p, VAR);
-
-    ENV = cons(p, ENV);
-
-    return p;
-}
-
-Cons *eval(Cons *x, Cons *env);
-
-Cons *evalcond(Cons *expr, Cons *env) {
-    if (expr == nil) {
-        return nil;
-    }
-
-    if (eval(car(car(expr)), env) != nil) {
-        return eval(car(cdr(car(expr))), env);
-    }
-
-    return evalcond(cdr(expr), env);
-}
-
-Cons *pairargs(Cons *pars, Cons *args, Cons *env, bool prog) {
-    if (pars == nil) {
-        return env;
-    }
-
-    Cons *p = cons(nil, car(args)); // value of param is corresponding arg
-    p->u.symbol = _symbol(car(car(pars)));
-    rplact(p, VAR);
-
-    return cons(p, pairargs(cdr(pars), prog ? cons(nil, nil) : cdr(args), env, prog));
-}
-
-Cons *evalargs(Cons *args, Cons *env) {
-    if (args == nil) {
-        return nil;
-    }
-
-    return cons(eval(car(args), env), evalargs(cdr(args), env));
-}
-
-// find_labels - change the type of all labels in a PROG to LABL
-void find_labels(Cons *p) {
-    for ( ; p != nil; p = cdr(p)) {
-        if (_type(car(p)) == VAR) {
-            rplact(car(p), LABL);        // change the type to LABL
-            rplacd(car(car(p)), cdr(p)); // label points to next statement
-        }
-    }
-}
-
-bool progon;
-
-Cons *evalprog(Cons *p, Cons *env) {
-    Cons *x = nil;
-
-    // set up parameters as locals
-    env = pairargs(car(cdr(p)), cons(nil, nil), env, true);
-    progon = true;
-    p = cdr(cdr(p)); // p now points to the statement list
-    find_labels(p);  // set up all labels in the prog
-
-    while (p != nil && progon) {
-        x = eval(car(p), env);
-        if (_type(car(car(p))) == GO) {
-            p = x;      // GO returned the next statement to go to
-        } else {
-            p = cdr(p); // just follow regular chain of statements
-
-        }
-    }
-
-    progon = true; // in case of nested progs
-    return x;
-}
-
-Cons *lookup(Cons *env, const char *name) {
-    Cons *p = env;
-
-    while (p != nil && strcmp(_symbol(car(p)), name) != 0) {
-        p = cdr(p);
-    }
-
-    return (p == nil) ? nil : car(p);
-}
-
-Cons *arith(Cons *op, Cons *x, Cons *y) {
-    int t = _type(op);
-
-    if (t == LESSP) {
-        return (_number(x) < _number(y)) ? TRUE : nil;
-    }
-    if (t == GREATERP) {
-        return (_number(x) > _number(y)) ? TRUE : nil;
-    }
-
-    int n = 0;
-
-    switch (t) {
-        case FPLUS: n = _number(x) + _number(y); break;
-        case FDIFF: n = _number(x) - _number(y); break;
-        case FTIMES: n = _number(x) * _number(y); break;
-        case FQUOT: n = _number(x) / _number(y); break;
-        case FADD1: n = _number(x) + 1; break;
-        case FSUB1: n = _number(x) - 1; break;
-    }
-
-    return number(n);
-}
-
-bool _isalpha(int c) {
-    return ('A' <= c && c <= 'Z') || ('a' <= c && c <= 'z') || strchr("!*+-/<=>?_", c) != nil; // 
-}
-
-bool _isdigit(int c) {
-    return ('0' <= c && c <= '9');
-}
-
-Cons *read_number() {
-    int c;
-    int n = 0;
-
-    while (true) {
-        c = _getc();
-        if (!_isdigit(c)) {
-            break;
-        }
-        n = n * 10 + c - '0';
-    }
-
-    _ungetc(c);
-
-    return number(n);
-}
-
-Cons *read_symbol() {
-    char inbuf[32 + 1];
-    char *s = inbuf;
-
-    {
-        int c = _getc();
-        *s = c;
-        s++;
-        if (c != '\'') {
-            while ((unsigned)(s - inbuf) < sizeof(inbuf) - 1) {
-                c = _getc();
-                if (!_isalpha(c) && !_isdigit(c)) {
-                    _ungetc(c);
-                    break;
-                }
-                *s = c;
-                s++;
-            }
-        }
-        *s = '\0';
-    }
-
-    Cons *q = lookup(ENV, inbuf);
-    if (q == nil) {
-        s = new char[strlen(inbuf) + 1];
-        strcpy(s, inbuf);
-        q = declare(s);
-    }
-
-    Cons *p = cons(q, nil);
-    rplact(p, _type(q));
-
-    return p;
-}
-
-int advance() {
-    int c;
-    while (true) {
-        c = _getc();
-        if (c == EOF) {
-            break;
-        }
-        if (strchr(" \t\r,", c) == nil) { // 
-            break;
-        }
-    }
-    _ungetc(c);
-    return c;
-}
-
-token_t read_token() {
-    int c = advance();
-
-    if (_isalpha(c)) {
-        return ALPHA;
-    }
-    if (_isdigit(c)) {
-        return DIGIT;
-    }
-
-    switch (c) {
-        case '(': case '[': return LPAREN;
-        case ')': case ']': return RPAREN;
-        case '\'': return QUOTED;
-        case '\n': return EOL;
-        case EOF: return EOT;
-    }
-
-    return ERR;
-}
-
-Cons *eq(Cons *x, Cons *y) {
-    if (x == nil || y == nil) {
-        if (x == y) {
-            return TRUE;
-        }
-    } else if (_type(x) == SYMBOL && _type(y) == SYMBOL && car(x) == car(y)) {
-        return TRUE;
-    }
-
-    return nil;
-}
-
-Cons *atom(Cons *x) {
-    if (x == nil) {
-        return TRUE;
-    }
-    int typ = _type(x);
-    if (typ == NUMBER || typ == SYMBOL) {
-         return TRUE;
-    }
-    return nil;
-}
-
-Cons *_and(Cons *x) {
-    for (Cons *p = cdr(x); p != nil; p = cdr(p)) {
-        if (eval(car(p), nil) == nil) {
-            return nil;
-        }
-    }
-    return TRUE;
-}
-
-Cons *_or(Cons *x) {
-    for (Cons *p = cdr(x); p != nil; p = cdr(p)) {
-        if (eval(car(p), nil) != nil) {
-            return TRUE;
-        }
-    }
+Cons *_bleuart(Cons **args, int n) {
+    bleuart();
     return nil;
 }
-
-Cons *_not(Cons *x) {
-    return (eval(cdr(x), nil) == nil) ? TRUE : nil;
-}
-
-Cons *_list(Cons *x) {
-    Cons *q = nil;
-
-    for (Cons *p = cdr(x); p != nil; p = cdr(p)) {
-        q = cons(q, car(p));
-    }
-
-    return q;
-}
-
-void var_to_user(Cons *p) {
-    if (p != nil) {
-        int t = _type(p);
-
-        if (t == VAR) {
-            if (_type(car(p)) == FUSER) {
-                rplact(p, FUSER);
-            }
-        } else if (t == LIST) {
-            var_to_user(car(p));
-            var_to_user(cdr(p));
-        }
-    }
-}
-
-void var_to_atom(Cons *p) {
-    if (p != nil) {
-        int t = _type(p);
-
-        if ((t != LIST && !isfunc(t)) || t == FUSER) {
-            rplact(p, SYMBOL);
-        } else {
-            var_to_atom(car(p));
-            var_to_atom(cdr(p));
-        }
-    }
-}
-
-Cons *read() {
-    switch (read_token()) {
-        case LPAREN: {
-            _getc();
-            Cons *p = cons(read(), read());
-            rplact(p, LIST);
-            return p;
-        }
-
-        case ALPHA:
-            return cons(read_symbol(), read());
-
-        case QUOTED: {
-            Cons *p = cons(read_symbol(), read());
-            rplaca(p, cons(car(p), cons(car(cdr(p)), nil)));
-            rplacd(p, cdr(cdr(p)));
-            return p;
-        }
-
-        case DIGIT:
-            return cons(read_number(), read());
-
-        case RPAREN:
-            _getc();
-            return nil;
-
-        case EOL:
-        case EOT:
-        case ERR:
-            _getc();
-            return nil;
-    }
-}
-
-void print(Cons *p) {
-    if (p == nil) {
-        return;
-    }
-
-    int t = _type(p);
-
-    if (t == NUMBER) {
-        _putn(_number(p));
-    } else if (t == SYMBOL) {
-        _puts(_symbol(car(p)));
-    } else if (_type(car(p)) == LIST) {
-        _putc('(');
-        print(car(p));
-        _putc(')');
-        print(cdr(p));
-    } else if (t == LIST) {
-        print(car(p));
-        print(cdr(p));
-    } else {
-        _puts("\033[31m" "?" "\033[0m");
-    }
-}
-
-Cons *eval(Cons *x, Cons *env) {
-    if (x == nil) {
-        return nil;
-    }
-
-    int t = _type(x);
-
-    if (t == VAR) {
-        return cdr(lookup(env, _symbol(car(x))));
-    }
-    if (t == NUMBER) {
-        return x;
-    }
-    if (t == LABL) {
-        return nil;
-    }
-
-    switch (_type(car(x))) {
-        case T:
-            return TRUE;
-
-        case NIL:
-            return nil;
-
-        case QUOTE:
-            var_to_atom(car(cdr(x)));
-            return car(cdr(x));
-
-        case FCAR: return car(eval(cdr(x), env));
-        case FCDR: return cdr(eval(cdr(x), env));
-
-        case FATOM:
-            return atom(eval(cdr(x), env));
-
-        case EQP: return eq(eval(car(cdr(x)), env), eval(cdr(cdr(x)), env));
-        case NULLP: return eq(eval(car(cdr(x)), env), nil);
-
-        case FCONS:
-            return cons(eval(car(cdr(x)), env), eval(cdr(cdr(x)), env));
-
-        case FLIST:
-            return _list(x);
-
-        case COND:
-            return evalcond(cdr(x), env);
-
-        case FSETQ: {
-            Cons *p = eval(cdr(cdr(x)), env);
-            rplacd(lookup(env, _symbol(car(car(cdr(x))))), p);
-            return p;
-        }
-
-        case DEFUN: {
-            Cons *p = car(car(cdr(x)));
-            rplact(p, FUSER);
-            rplacd(p, cdr(cdr(x)));
-            var_to_user(cdr(cdr(cdr(x))));
-            return nil;
-        }
-
-        case FUSER: {
-            Cons *p = cdr(car(car(x))); // p is statement list
-            return eval(car(cdr(p)), pairargs(car(p), evalargs(cdr(x), env), env, false));
-        }
-
-        case FAPPLY:
-        case FUNCALL: {
-            Cons *p = eval(car(cdr(x)), env); // func name
-            t = _type(car(p));
-            if (isfunc(t)) {
-                p = cons(p, cdr(cdr(x)));
-                if (t == FUSER) {
-                    rplact(car(p), FUSER);
-                }
-                Cons *q = eval(p, env);
-                rplact(car(p), t);
-                return q;
-            }
-            return nil;
-        }
-
-        case FEVAL: {
-            Cons *p = eval(cdr(x), env);
-            if (_type(p) == SYMBOL) {
-                return cdr(lookup(env, _symbol(car(p))));
-            }
-            return eval(p, env);
-        }
-
-        case FPRINT:
-            print(eval(car(cdr(x)), env));
-            _putc('\n');
-            return nil;
-
-        case FREAD:
-            return read();
-
-        case FAND: return _and(x);
-        case FOR: return _or(x);
-        case FNOT: return _not(x);
-
-        case FPLUS:
-        case FDIFF:
-        case FTIMES:
-        case FQUOT:
-        case GREATERP:
-        case LESSP:
-            return arith(car(x), eval(car(cdr(x)), env), eval(cdr(cdr(x)), env));
-
-        case FADD1:
-        case FSUB1:
-            return arith(car(x), eval(car(cdr(x)), env), nil);
-
-        case ZEROP: {
-            Cons *p = eval(car(cdr(x)), env);
-            return (_number(p) == 0) ? TRUE : nil;
-        }
-
-        case NUMBERP: {
-            t = _type(eval(car(cdr(x)), env));
-            return (t == NUMBER) ? TRUE : nil;
-        }
-
-        case PROG:
-            return evalprog(x, env);
-
-        case GO:
-            return cdr(car(car(cdr(x))));
-
-        case RETRN:
-            progon = false;
-            return eval(cdr(x), env);
-
-        case LIST:
-            if (cdr(x) == nil) {
-                return eval(car(x), env);
-            }
-            return cons(eval(car(x), env), eval(cdr(x), env));
-
-        case VAR:
-            return cdr(lookup(env, _symbol(car(car(x)))));
-
-        case NUMBER:
-            return car(x);
-
-#if FEATURE_BLE
-        case BLEUART:
-            bleuart();
-            return nil;
 #endif
 
 #if DEVICE_ANALOGIN
-        case ZOOLOG:
-            zoolog();
-            return nil;
-#endif
-    }
-
+Cons *_zoolog(Cons **args, int n) {
+    zoolog();
     return nil;
 }
-
-void repl() {
-    Cons *p = nil;
-    bool cont = false;
-    bool oops = false;
-
-    while (true) {
-        if (!cont && !oops) {
-            _puts("\033[31m" "ζ " "\033[32m" "=> " "\033[0m");
-            _flush();
-        }
-
-        switch (read_token()) {
-            case LPAREN:
-                _getc();
-                p = eval(read(), ENV);
-                cont = true;
-                break;
-
-            case ALPHA:
-                p = cdr(car(read_symbol()));
-                cont = true;
-                break;
-
-            case QUOTED:
-            case RPAREN:
-            case DIGIT:
-            case ERR:
-                _getc();
-                _puts("\033[33m" "oops!" "\033[0m" "\n");
-                p = nil;
-                oops = true;
-                break;
-
-            case EOL:
-                _getc();
-                if (!oops) {
-                    if (p == nil) {
-                        _puts("nil");
-                    } else {
-                        print(cons(p, nil));
-                    }
-                    _putc('\n');
-                }
-                p = nil;
-                cont = false;
-                oops = false;
-                break;
-
-            case EOT:
-                _getc();
-                return;
-        }
-    }
-}
-
-Cons *def(const char *name, int t) {
-    Cons *p = declare(name);
-    rplact(p, t);
-    return p;
-}
+#endif
 
 int main() {
-    TRUE = cons(def("t", T), nil);
-    rplact(TRUE, SYMBOL);
-
-    def("'", QUOTE); def("quote", QUOTE);
-    def("add1", FADD1); def("inc", FADD1);
-    def("and", FAND);
-    def("apply", FAPPLY);
-    def("atom", FATOM);
-    def("car", FCAR); def("first", FCAR);
-    def("cdr", FCDR); def("next", FCDR);
-    def("cond", COND);
-    def("cons", FCONS);
-    def("defun", DEFUN); def("defn", DEFUN);
-    def("diff", FDIFF); def("-", FDIFF);
-    def("eq", EQP); def("=", EQP);
-    def("eval", FEVAL);
-    def("funcall", FUNCALL);
-    def("go", GO);
-    def("greaterp", GREATERP); def(">", GREATERP);
-    def("lessp", LESSP); def("<", LESSP);
-    def("nil", NIL);
-    def("not", FNOT);
-    def("null", NULLP); def("nil?", NULLP);
-    def("numberp", NUMBERP); def("number?", NUMBERP);
-    def("or", FOR);
-    def("plus", FPLUS); def("+", FPLUS);
-    def("print", FPRINT);
-    def("prog", PROG);
-    def("quot", FQUOT); def("/", FQUOT);
-    def("read", FREAD);
-    def("return", RETRN);
-    def("rplaca", FREPLACA);
-    def("rplacd", FREPLACD);
-    def("setq", FSETQ);
-    def("sub1", FSUB1); def("dec", FSUB1);
-    def("times", FTIMES); def("*", FTIMES);
-    def("zerop", ZEROP); def("zero?", ZEROP);
+    console_init();
+    CortexIo console = { console_getc, console_putc, console_flush, nil, console_write };
+    Cortex cortex(console);
 
 #if FEATURE_BLE
-    def("bleuart", BLEUART);
+    cortex.define("bleuart", _bleuart, 0);
 #endif
 #if DEVICE_ANALOGIN
-    def("zoolog", ZOOLOG);
+    cortex.define("zoolog", _zoolog, 0);
+#endif
+
+#if COMPONENT_FLASHIAP
+    if (fs.mount(&flash) != 0) {
+        fs.reformat(&flash);
+    }
+    cortex.eval("(load-image) (load \"/fs/boot.lisp\")");
 #endif
 
-    repl();
+    cortex.repl();
 
     return 0;
 }
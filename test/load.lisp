@@ -0,0 +1,4 @@
+; load - read by regress in chunks; the string and the defun below run across their ends
+
+(setq loaded "a string long enough that it runs across the end of the first chunk of the file")
+(defun loaded-length () (vec-length loaded))
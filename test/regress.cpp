@@ -0,0 +1,202 @@
+// regress - host checks of cases that once went wrong, from the top of the tree:
+//
+//   g++ -O2 -o cortex-regress test/regress.cpp src/cortex.cpp
+//   ./cortex-regress
+//
+// each case evaluates its setup, then its expression, and compares what print makes of the
+// value, or the error if there is one, with what it should be; a line is reported per failure
+// and the exit status is their count
+
+#include "../src/cortex.h"
+
+#include <stdio.h>
+#include <string.h>
+
+struct Case {
+    const char *name;
+    const char *setup;
+    const char *expr;
+    const char *value; // as printed, or the error
+};
+
+Case cases[] = {
+    { "parameters and prog variables resolved to slots",
+      "(defun lx (a b) (prog (c) (setq c (plus a b))"
+      " (return (prog (a) (setq a 10) (return (plus a c))))))",
+      "(lx 1 2)", "13" },
+    { "name of the caller looked up from a called function",
+      "(defun lxo (seen) (lxi)) (defun lxi () (add1 seen))", "(lxo 4)", "5" },
+
+    { "cells kept across collections",
+      "(defun gcmk (n) (prog (l) loop (cond ((zerop n) (return l))) (setq l (cons n l))"
+      " (setq n (sub1 n)) (go loop)))"
+      " (defun gclen (l k) (cond ((null l) k) (t (gclen (cdr l) (add1 k)))))"
+      " (defun gcwaste (n) (prog () loop (cond ((zerop n) (return nil))) (gcmk 5000)"
+      " (setq n (sub1 n)) (go loop)))"
+      " (setq gckeep (gcmk 3000)) (gcwaste 20) (gc)",
+      "(gclen gckeep 0)", "3000" },
+
+    { "fixnums below zero", "", "(quot (diff 0 7) 2)", "-3" },
+    { "fixnum product that stays a fixnum", "", "(times 1000 1000)", "1000000" },
+
+    { "float told from a pair by its tag", "", "(atom 2.5)", "t" },
+    { "pair told from an atom by its tag", "", "(atom (cons 1 2))", "nil" },
+    { "symbol told from a number by its tag", "", "(numberp 'x)", "nil" },
+
+    { "symbol past the token buffer, cut to it",
+      "(setq aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaazzzzzz 5)", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "5" },
+    { "quoted list nested in a list", "", "(car (car (cdr '(1 ((2 3)) 4))))", "(23)" },
+    { "string with escapes", "", "(vec-length \"a\\\"b\\\\\")", "4" },
+
+    { "bench workload: fib",
+      "(defun bfib (n) (cond ((lessp n 2) n) (t (plus (bfib (diff n 1)) (bfib (diff n 2))))))",
+      "(bfib 20)", "6765" },
+    { "bench workload: tak",
+      "(defun btak (x y z) (cond ((not (lessp y x)) z) (t (btak (btak (diff x 1) y z) (btak (diff y 1) z x) (btak (diff z 1) x y)))))",
+      "(btak 18 12 6)", "7" },
+
+    { "native alias", "", "(+ 1 2 3)", "6" },
+    { "native alias for car", "", "(first (cons 1 nil))", "1" },
+    { "arguments cut to the arity", "", "(add1 1 2)", "2" },
+    { "defun over a builtin", "", "(defun car (x) x)", "builtin" },
+
+    { "image saved and loaded back",
+      "(setq imgv 41) (defun imgf (x) (plus x imgv)) (save-image) (setq imgv 0) (defun imgf (x) x) (load-image)",
+      "(imgf 1)", "42" },
+
+    { "file loaded in chunks", "(load \"test/load.lisp\")", "(loaded-length)", "79" },
+
+    { "fixnum product past the range, promoted", "", "(times 100000 100000)", "1e+10" },
+    { "fixnum sum past the range, promoted", "", "(plus 2147483647 1)", "2.14748e+09" },
+    { "q15 product", "", "(q15* (q15 0.5) (q15 0.5))", "8192" },
+    { "q15 back to float", "", "(q15-float 8192)", "0.25" },
+
+    { "concat of a string and a symbol", "", "(concat \"ab\" 'cd)", "\"abcd\"" },
+    { "substring", "", "(substr \"hello\" 1 3)", "\"el\"" },
+    { "byte of a string", "", "(buf-ref \"A\" 0)", "65" },
+
+    { "memo table past its capacity evicts",
+      "(defun msq (x) (times x x)) (memoize 'msq 2) (msq 1) (msq 2) (msq 3) (msq 1)",
+      "(memo-stats 'msq)", "(0422)" },
+
+    { "funcall of a quoted native", "", "(funcall 'plus 1 2)", "3" },
+    { "funcall of a function in a variable", "(setq fnv 'add1)", "(funcall fnv 4)", "5" },
+    { "funcall after a redefinition",
+      "(defun fnr (x) x) (funcall 'fnr 1) (defun fnr (x) (plus x 10))", "(funcall 'fnr 1)", "11" },
+
+    { "string printed with its escapes", "", "(concat \"a\\\"b\")", "\"a\\\"b\"" },
+    { "least fixnum printed", "", "(diff 0 2147483647 1)", "-2147483648" },
+
+    { "expression across a CR LF line end", "", "(plus 1\r\n2)", "3" },
+    { "float ended by a CR LF line end", "", "(plus 1.5\r\n2)", "3.5" },
+    { "number ended by the parenthesis of the next form", "", "(car (cons 12(quote x)))", "12" },
+
+    { "label named like a builtin", "", "(prog (i) car (return 5))", "5" },
+
+    { "go to a label named like a builtin",
+      "(defun f (n) (prog (i) (setq i 0) car (setq i (add1 i)) (cond ((lessp i n) (go car)))"
+      " (return i)))",
+      "(f 3)", "3" },
+
+    { "go nested in a statement of an evaluated prog", "",
+      "(prog (i) (setq i 0) l (setq i (plus i 1)) (cond ((lessp i 3) (go l))) (return i))", "3" },
+    { "go nested in a statement of a compiled prog",
+      "(defun f () (prog (i) (setq i 0) l (setq i (plus i 1)) (cond ((lessp i 3) (go l)))"
+      " (return i)))",
+      "(f)", "3" },
+    { "go to a label of an outer prog", "",
+      "(prog (j) (setq j 0) o (setq j (add1 j)) (prog () (cond ((lessp j 4) (go o))) (return 9))"
+      " (return j))",
+      "4" },
+
+    { "tail call to itself", "(defun down (n) (cond ((zerop n) 0) (t (down (sub1 n)))))",
+      "(down 100000)", "0" },
+    { "tail calls between functions of other parameters",
+      "(defun ev (n) (cond ((zerop n) t) (t (od (sub1 n)))))"
+      " (defun od (m) (cond ((zerop m) nil) (t (ev (sub1 m)))))",
+      "(ev 100000)", "t" },
+    { "tail call that leaves the caller's names to find",
+      "(defun outer (x) (inner 1)) (defun inner (y) (plus x y))", "(outer 5)", "6" },
+
+    { "integer literal past a long long", "", "(plus 0 100000000000000000000)", "1e+20" },
+
+    { "fix of the float just past a fixnum", "", "(fix 2147483648.0)", "overflow" },
+    { "fix of the float just below a fixnum", "", "(fix (diff 0 2147483904.0))", "overflow" },
+    { "fix of the least fixnum", "", "(fix (diff 0 2147483648.0))", "-2147483648" },
+
+    { "dot of int16 vectors of the least int16",
+      "(defun fill (v n x) (prog (i) (setq i 0) l (cond ((null (lessp i n)) (return v)))"
+      " (vec-set v i x) (setq i (add1 i)) (go l)))"
+      " (setq v (fill (vector 'i16 8) 8 (diff 0 32768)))",
+      "(vec-dot v v)", "8.58993e+09" },
+
+    { "int32 vector scaled by one",
+      "(setq v32 (vector 'i32 1)) (vec-set v32 0 16777217) (vec-scale v32 1)",
+      "(vec-ref v32 0)", "16777217" },
+    { "int16 vector scaled past its range",
+      "(setq v16 (vector 'i16 1)) (vec-set v16 0 1000) (vec-scale v16 100)",
+      "(vec-ref v16 0)", "32767" },
+
+    { "load of a path in a string", "", "(load \"/no/such/file.lisp\")", "nil" },
+    { "load of a path in a slice", "", "(load (substr \"/no/such/file.lisp\" 0 8))", "nil" },
+    { "load of a path that is no path", "", "(load 5)", "not a path" },
+
+    { "function redefined while it runs",
+      "(defun g (n) (prog () (defun g (n) (times n 2)) (return (add1 n)))) (g 1)", "(g 5)", "10" },
+    { "function redefined while it runs, then unwound",
+      "(defun h (n) (prog () (defun h (n) n) (return (car n)))) (h 1)", "(h 7)", "7" },
+
+    { "native of the host called from a function", "(defun f () (bump))", "(diff (f) (f))", "-1" },
+};
+
+char out[256];
+int nout;
+
+int bumps;
+
+// bump - a native with an effect, the count of its calls
+Cons *bump(Cons **a, int n) { return number(++bumps); }
+
+int null_getc(void *) { return EOF; }
+
+void buf_putc(int c, void *) {
+    if (nout < (int)sizeof(out) - 1) {
+        out[nout++] = c;
+    }
+}
+
+// the output goes through write, a run at a time, as it does on the device
+void buf_write(const char *s, size_t n, void *) {
+    for (size_t i = 0; i < n; i++) {
+        buf_putc(s[i], nil);
+    }
+}
+
+int main() {
+    CortexIo io = { null_getc, buf_putc, nil, nil, buf_write };
+    Cortex cortex(io);
+    int failed = 0;
+
+    cortex.define("bump", bump, 0);
+
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        Case *c = &cases[i];
+
+        cortex.eval(c->setup);
+        Cons *p = cortex.eval(c->expr);
+        const char *error = cortex.error();
+
+        nout = 0;
+        cortex.print(p);
+        out[nout] = '\0';
+
+        const char *got = (error != nil) ? error : out;
+        if (strcmp(got, c->value) != 0) {
+            printf("%s: %s is %s, not %s\n", c->name, c->expr, got, c->value);
+            failed++;
+        }
+    }
+
+    remove("cortex.img"); // left by the image cases
+    return failed;
+}